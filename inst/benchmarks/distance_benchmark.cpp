@@ -0,0 +1,110 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+/*
+ * Compares the scalar distance kernels with the kernels selected at run time
+ * for the instruction set of the machine, on all the pairs of uniform random
+ * points, for each metric. The two kernels must agree up to rounding.
+ *
+ * Build and run from this directory with
+ *
+ *   g++ -O2 -I../../src distance_benchmark.cpp -o distance_benchmark
+ *   ./distance_benchmark [points] [dimension]
+ */
+
+#include "distance_kernels.h"
+#include "random_utility.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+using namespace cph;
+
+static double elapsed(const std::clock_t start)
+{
+	return double(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double sum_distances(const distance_kernels<double>::kernel_function kernel, const std::vector<double> & points, const std::size_t n,
+		const std::size_t d, const double p, std::vector<double> & distances)
+{
+	double sum(0);
+	std::size_t k(0);
+
+	for (std::size_t i = 0; i < n; i++)
+	{
+		for (std::size_t j = i + 1; j < n; j++)
+		{
+			distances[k] = kernel(&points[i * d], &points[j * d], d, 1, p);
+			sum += distances[k++];
+		}
+	}
+
+	return sum;
+}
+
+int main(int argc, char ** argv)
+{
+	const std::size_t n = (argc > 1 ? std::atoi(argv[1]) : 2000);
+	const std::size_t d = (argc > 2 ? std::atoi(argv[2]) : 32);
+
+	// a quarter of the coordinates are zero, so that the binary and canberra
+	// metrics see both cases
+	std::vector<double> points(n * d);
+	for (std::size_t k = 0; k < points.size(); k++)
+	{
+		points[k] = (random_utility::random_uniform() < 0.25 ? 0 : random_utility::random_uniform());
+	}
+
+	const char * names[] = { "euclidean", "maximum", "manhattan", "canberra", "binary", "minkowski" };
+	const metric metrics[] = { euclidean, maximum, manhattan, canberra, binary, minkowski };
+	const double powers[] = { 2, 2, 2, 2, 2, 3 };
+
+	std::printf("%lu points of dimension %lu, %s kernels\n", (unsigned long) n, (unsigned long) d, distance_kernels<double>::instruction_set());
+	std::printf("%-12s %12s %12s %10s\n", "", "scalar (s)", "dispatch (s)", "speedup");
+
+	const std::size_t pairs = n * (n - 1) / 2;
+	std::vector<double> scalar_distances(pairs), dispatched_distances(pairs);
+
+	int status(0);
+	for (std::size_t m = 0; m < sizeof(metrics) / sizeof(metrics[0]); m++)
+	{
+		const double p = powers[m];
+
+		std::clock_t start = std::clock();
+		const double scalar_sum = sum_distances(distance_kernels<double>::scalar_kernel(metrics[m], p), points, n, d, p, scalar_distances);
+		const double scalar_time = elapsed(start);
+
+		start = std::clock();
+		const double dispatched_sum = sum_distances(distance_kernels<double>::kernel(metrics[m], p), points, n, d, p, dispatched_distances);
+		const double dispatched_time = elapsed(start);
+
+		std::printf("%-12s %12.4f %12.4f %10.2f\n", names[m], scalar_time, dispatched_time, scalar_time / dispatched_time);
+
+		for (std::size_t k = 0; k < pairs; k++)
+		{
+			if (std::fabs(scalar_distances[k] - dispatched_distances[k]) > 1e-12 * std::fabs(scalar_distances[k]))
+			{
+				std::printf("%s distances differ: %g %g\n", names[m], scalar_distances[k], dispatched_distances[k]);
+				status = 1;
+				break;
+			}
+		}
+
+		// keeps the sums alive
+		if (scalar_sum < 0 || dispatched_sum < 0)
+		{
+			status = 1;
+		}
+	}
+
+	return status;
+}
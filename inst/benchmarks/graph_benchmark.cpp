@@ -0,0 +1,124 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+/*
+ * Compares the map based basic_graph with csr_graph on the 1-skeleton of a
+ * Vietoris-Rips complex of uniform random points: construction from an edge
+ * list, and lower neighbor lists followed by weight lookups along every path
+ * u > v > w, which is the access pattern of the flag complex expansion.
+ *
+ * Build and run from this directory with
+ *
+ *   g++ -O2 -I../../src graph_benchmark.cpp -o graph_benchmark
+ *   ./graph_benchmark [points] [threshold]
+ */
+
+#include "basic_graph.h"
+#include "csr_graph.h"
+#include "weighted_edge.h"
+#include "euclidean_metric_space.h"
+#include "random_utility.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+using namespace cph;
+
+static double elapsed(const std::clock_t start)
+{
+	return double(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+template<class G>
+static double sum_path_weights(const G & graph, const std::size_t n)
+{
+	double sum(0);
+	std::vector<std::size_t> u_neighbors, v_neighbors;
+
+	for (std::size_t u = 0; u < n; u++)
+	{
+		graph.lower_neighbor_list(u, u_neighbors);
+		for (std::size_t a = 0; a < u_neighbors.size(); a++)
+		{
+			const std::size_t v = u_neighbors[a];
+			graph.lower_neighbor_list(v, v_neighbors);
+			for (std::size_t b = 0; b < v_neighbors.size(); b++)
+			{
+				const std::size_t w = v_neighbors[b];
+				sum += graph.get_weight(u, v) + graph.get_weight(v, w);
+			}
+		}
+	}
+
+	return sum;
+}
+
+int main(int argc, char ** argv)
+{
+	const std::size_t n = (argc > 1 ? std::atoi(argv[1]) : 2000);
+	const double threshold = (argc > 2 ? std::atof(argv[2]) : 0.1);
+
+	basic_matrix<double> * points = new basic_matrix<double> (n, 3);
+	for (std::size_t i = 0; i < n; i++)
+	{
+		for (std::size_t j = 0; j < 3; j++)
+		{
+			(*points)(i, j) = random_utility::random_uniform();
+		}
+	}
+	euclidean_metric_space<double> metric_space(points);
+
+	std::vector<weighted_edge<double> > edges;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		for (std::size_t j = i + 1; j < n; j++)
+		{
+			const double distance = metric_space.distance(i, j);
+			if (distance <= threshold)
+			{
+				edges.push_back(weighted_edge<double> (i, j, distance));
+			}
+		}
+	}
+
+	std::printf("%lu points, %lu edges\n", (unsigned long) n, (unsigned long) edges.size());
+
+	std::clock_t start = std::clock();
+	basic_graph<double> map_graph;
+	for (std::size_t e = 0; e < edges.size(); e++)
+	{
+		map_graph.add_edge(edges[e].i, edges[e].j, edges[e].weight);
+	}
+	const double map_build = elapsed(start);
+
+	start = std::clock();
+	csr_graph<double> compressed_graph(edges, n);
+	const double csr_build = elapsed(start);
+
+	start = std::clock();
+	const double map_sum = sum_path_weights(map_graph, n);
+	const double map_lookup = elapsed(start);
+
+	start = std::clock();
+	const double csr_sum = sum_path_weights(compressed_graph, n);
+	const double csr_lookup = elapsed(start);
+
+	std::printf("%-12s %12s %12s\n", "", "build (s)", "lookup (s)");
+	std::printf("%-12s %12.4f %12.4f\n", "basic_graph", map_build, map_lookup);
+	std::printf("%-12s %12.4f %12.4f\n", "csr_graph", csr_build, csr_lookup);
+
+	if (map_sum != csr_sum)
+	{
+		std::printf("weight sums differ: %g %g\n", map_sum, csr_sum);
+		return 1;
+	}
+
+	return 0;
+}
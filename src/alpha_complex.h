@@ -0,0 +1,333 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef ALPHA_COMPLEX_H_
+#define ALPHA_COMPLEX_H_
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "simplex.h"
+#include "simplex_stream.h"
+#include "weighted_edge.h"
+#include "euclidean_metric_space.h"
+#include "delaunay_triangulation.h"
+#include "parallel_utility.h"
+
+namespace cph
+{
+
+	/*
+	 * The alpha complex filtration of a point cloud in dimension 1 to 3 with the
+	 * euclidean metric. Its simplices are those of the Delaunay triangulation,
+	 * and a simplex enters when it has an empty circumsphere of the current
+	 * size, so the complex at each scale has the homotopy type of the Cech
+	 * complex, but with O(n) simplices in the plane rather than the O(n^k) of the
+	 * Vietoris-Rips complex.
+	 *
+	 * Filtration values are in the scale of vietoris_rips_complex, as diameters
+	 * rather than radii: a simplex whose smallest circumsphere is empty (is
+	 * Gabriel) enters at the diameter of that sphere, so that an edge enters at
+	 * its length, and any other simplex enters with the first of its cofaces.
+	 * The values are computed top down over the dimensions, as in Edelsbrunner
+	 * and Harer. They are those of the slightly perturbed points of
+	 * delaunay_triangulation.
+	 */
+	template<class T>
+	class alpha_complex: public simplex_stream<simplex<std::size_t> , T>
+	{
+	private:
+		static const std::size_t WIDTH = delaunay_triangulation<T>::MAX_DIMENSION + 1;
+
+		typedef std::vector<std::pair<T, simplex<std::size_t> > > simplex_buffer;
+
+		/*
+		 * A face of a simplex of the next dimension up, with the vertex of the
+		 * simplex opposite to it and the filtration value of the simplex.
+		 */
+		struct face_record
+		{
+			std::size_t vertices[WIDTH];
+			std::size_t opposite;
+			T coface_value;
+
+			bool operator <(const face_record & other) const
+			{
+				return std::lexicographical_compare(this->vertices, this->vertices + WIDTH, other.vertices, other.vertices + WIDTH);
+			}
+
+			bool same_face(const face_record & other) const
+			{
+				return std::equal(this->vertices, this->vertices + WIDTH, other.vertices);
+			}
+		};
+
+		const euclidean_metric_space<T> & _metric_space;
+		const T _max_filtration_value;
+		const std::size_t _max_dimension;
+
+	public:
+		alpha_complex(const euclidean_metric_space<T> & metric_space, const T & max_filtration_value, const std::size_t max_dimension) :
+			_metric_space(metric_space), _max_filtration_value(max_filtration_value), _max_dimension(max_dimension)
+		{
+		}
+
+		virtual ~alpha_complex()
+		{
+		}
+
+		void construct()
+		{
+			simplex_buffer buffer;
+			this->compute_filtration(this->_max_dimension, buffer);
+
+			std::sort(buffer.begin(), buffer.end(), ordered_comparison<T, simplex<std::size_t> > ());
+
+			for (typename simplex_buffer::const_iterator iter = buffer.begin(); iter != buffer.end(); iter++)
+			{
+				this->add_simplex(iter->second, iter->first);
+			}
+		}
+
+		/*
+		 * The edges of the complex, which is all that is needed for 0-dimensional
+		 * persistence.
+		 */
+		std::vector<weighted_edge<T> > get_1_skeleton() const
+		{
+			simplex_buffer buffer;
+			this->compute_filtration(1, buffer);
+
+			std::vector<weighted_edge<T> > edges;
+			for (typename simplex_buffer::const_iterator iter = buffer.begin(); iter != buffer.end(); iter++)
+			{
+				if (iter->second.dimension() == 1)
+				{
+					edges.push_back(weighted_edge<T> (iter->second[0], iter->second[1], iter->first));
+				}
+			}
+
+			return edges;
+		}
+
+	private:
+		/*
+		 * Appends the simplices of dimension at most max_dimension with filtration
+		 * values at most _max_filtration_value to buffer, in no particular order.
+		 */
+		void compute_filtration(const std::size_t max_dimension, simplex_buffer & buffer) const
+		{
+			const std::size_t n = this->_metric_space.size();
+			for (std::size_t v = 0; v < n; v++)
+			{
+				buffer.push_back(std::make_pair(T(0), simplex<std::size_t>::make_simplex(v)));
+			}
+
+			if (n < 2)
+			{
+				return;
+			}
+
+			const delaunay_triangulation<T> triangulation(this->_metric_space.points());
+
+			std::size_t k(0);
+			std::vector<std::size_t> simplices = triangulation.maximal_simplices(k);
+			std::vector<T> values(simplices.size() / (k + 1));
+
+			CPH_OMP(parallel for schedule(static))
+			for (std::size_t s = 0; s < values.size(); s++)
+			{
+				T squared_radius(0);
+				this->circumsphere(triangulation, &simplices[s * (k + 1)], k + 1, 0, squared_radius);
+				values[s] = 2 * std::sqrt(squared_radius);
+			}
+
+			while (k > 0)
+			{
+				if (k <= max_dimension)
+				{
+					for (std::size_t s = 0; s < values.size(); s++)
+					{
+						if (values[s] <= this->_max_filtration_value)
+						{
+							buffer.push_back(std::make_pair(values[s], alpha_complex::make_simplex(&simplices[s * (k + 1)], k + 1)));
+						}
+					}
+				}
+
+				if (k == 1)
+				{
+					break;
+				}
+
+				std::vector<face_record> records;
+				records.reserve(values.size() * (k + 1));
+				for (std::size_t s = 0; s < values.size(); s++)
+				{
+					const std::size_t * vertices = &simplices[s * (k + 1)];
+					for (std::size_t i = 0; i <= k; i++)
+					{
+						face_record record;
+						std::fill(record.vertices, record.vertices + WIDTH, std::size_t(0));
+						std::copy(vertices, vertices + i, record.vertices);
+						std::copy(vertices + i + 1, vertices + k + 1, record.vertices + i);
+						record.opposite = vertices[i];
+						record.coface_value = values[s];
+						records.push_back(record);
+					}
+				}
+				std::sort(records.begin(), records.end());
+
+				std::vector<std::size_t> group_starts;
+				for (std::size_t r = 0; r < records.size(); r++)
+				{
+					if (r == 0 || !records[r].same_face(records[r - 1]))
+					{
+						group_starts.push_back(r);
+					}
+				}
+				group_starts.push_back(records.size());
+
+				const std::size_t groups = group_starts.size() - 1;
+				simplices.resize(groups * k);
+				values.resize(groups);
+
+				// a face is attached if the vertex opposite to it in one of its cofaces is
+				// inside its smallest circumsphere; it then enters with its first coface
+				CPH_OMP(parallel for schedule(static))
+				for (std::size_t g = 0; g < groups; g++)
+				{
+					const face_record * begin = &records[group_starts[g]];
+					const face_record * end = &records[0] + group_starts[g + 1];
+
+					std::copy(begin->vertices, begin->vertices + k, &simplices[g * k]);
+
+					T squared_radius(0);
+					bool attached(false);
+					T first_coface(begin->coface_value);
+					for (const face_record * record = begin; record != end; record++)
+					{
+						attached = attached || this->circumsphere(triangulation, begin->vertices, k, record->opposite, squared_radius);
+						first_coface = std::min(first_coface, record->coface_value);
+					}
+
+					values[g] = (attached ? first_coface : 2 * std::sqrt(squared_radius));
+				}
+
+				k--;
+			}
+		}
+
+		/*
+		 * Computes the squared radius of the smallest sphere through the given
+		 * points, whose center lies in their affine hull, and returns whether the
+		 * point query is strictly inside it.
+		 */
+		bool circumsphere(const delaunay_triangulation<T> & triangulation, const std::size_t * vertices, const std::size_t size, const std::size_t query,
+				T & squared_radius) const
+		{
+			const std::size_t D = triangulation.dimension();
+			const std::size_t k = size - 1;
+			long double edges[WIDTH][WIDTH], gram[WIDTH][WIDTH + 1], center[WIDTH];
+
+			const T * origin = triangulation.point(vertices[0]);
+			for (std::size_t i = 0; i < k; i++)
+			{
+				for (std::size_t d = 0; d < D; d++)
+				{
+					edges[i][d] = (long double) triangulation.point(vertices[i + 1])[d] - origin[d];
+				}
+			}
+
+			// the center is origin + sum_i lambda_i edges[i], with 2 <edges[i], center - origin> = |edges[i]|^2
+			for (std::size_t i = 0; i < k; i++)
+			{
+				for (std::size_t j = 0; j < k; j++)
+				{
+					gram[i][j] = 0;
+					for (std::size_t d = 0; d < D; d++)
+					{
+						gram[i][j] += edges[i][d] * edges[j][d];
+					}
+				}
+				gram[i][k] = gram[i][i] / 2;
+			}
+
+			for (std::size_t column = 0; column < k; column++)
+			{
+				std::size_t pivot = column;
+				for (std::size_t row = column + 1; row < k; row++)
+				{
+					if (std::fabs(gram[row][column]) > std::fabs(gram[pivot][column]))
+					{
+						pivot = row;
+					}
+				}
+
+				if (gram[pivot][column] == 0)
+				{
+					// degenerate simplex
+					squared_radius = std::numeric_limits<T>::max();
+					return false;
+				}
+
+				for (std::size_t j = 0; j <= k; j++)
+				{
+					std::swap(gram[pivot][j], gram[column][j]);
+				}
+
+				for (std::size_t row = 0; row < k; row++)
+				{
+					if (row != column)
+					{
+						const long double factor = gram[row][column] / gram[column][column];
+						for (std::size_t j = column; j <= k; j++)
+						{
+							gram[row][j] -= factor * gram[column][j];
+						}
+					}
+				}
+			}
+
+			for (std::size_t d = 0; d < D; d++)
+			{
+				center[d] = 0;
+				for (std::size_t i = 0; i < k; i++)
+				{
+					center[d] += gram[i][k] / gram[i][i] * edges[i][d];
+				}
+			}
+
+			long double radius(0), distance(0);
+			for (std::size_t d = 0; d < D; d++)
+			{
+				radius += center[d] * center[d];
+				const long double offset = (long double) triangulation.point(query)[d] - origin[d] - center[d];
+				distance += offset * offset;
+			}
+
+			squared_radius = T(radius);
+			return (distance < radius);
+		}
+
+		static simplex<std::size_t> make_simplex(const std::size_t * vertices, const std::size_t size)
+		{
+			simplex<std::size_t> result = simplex<std::size_t>::make_simplex(vertices[0]);
+			for (std::size_t i = 1; i < size; i++)
+			{
+				result = result.append_to(vertices[i]);
+			}
+			return result;
+		}
+	};
+
+}
+
+#endif /* ALPHA_COMPLEX_H_ */
@@ -31,6 +31,15 @@ namespace cph
 		{
 		}
 
+		barcode_collection(const barcode_collection<T> & other) :
+			_num_intervals(other._num_intervals)
+		{
+			for (typename std::map<std::size_t, std::list<right_open_interval<T> > *>::const_iterator iter = other._intervals.begin(); iter != other._intervals.end(); iter++)
+			{
+				this->_intervals[iter->first] = new std::list<right_open_interval<T> >(*iter->second);
+			}
+		}
+
 		virtual ~barcode_collection()
 		{
 			for (typename std::map<std::size_t, std::list<right_open_interval<T> > *>::iterator iter = this->_intervals.begin(); iter != this->_intervals.end(); iter++)
@@ -11,6 +11,9 @@
 
 #include <map>
 #include <set>
+#include <vector>
+
+#include "weighted_edge.h"
 
 namespace cph
 {
@@ -100,6 +103,40 @@ namespace cph
 
 			return result;
 		}
+
+		std::vector<weighted_edge<W, V> > edges() const
+		{
+			std::vector<weighted_edge<W, V> > result;
+
+			for (typename std::map<V, std::map<V, W> * >::const_iterator iter = this->_adjacency_sets.begin(); iter != this->_adjacency_sets.end(); iter++)
+			{
+				for (typename std::map<V, W>::const_iterator edge = iter->second->begin(); edge != iter->second->end(); edge++)
+				{
+					result.push_back(weighted_edge<W, V>(edge->first, iter->first, edge->second));
+				}
+			}
+
+			return result;
+		}
+
+		void lower_neighbor_list(const V & y, std::vector<V> & result) const
+		{
+			result.clear();
+
+			if (_adjacency_sets.find(y) == _adjacency_sets.end())
+			{
+				return;
+			}
+
+			const std::map<V, W> * weighted_map = _adjacency_sets.find(y)->second;
+
+			result.reserve(weighted_map->size());
+
+			for (typename std::map<V, W>::const_iterator iter = weighted_map->begin(); iter != weighted_map->end(); iter++)
+			{
+				result.push_back((*iter).first);
+			}
+		}
 	};
 
 }
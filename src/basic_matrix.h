@@ -11,62 +11,125 @@
 
 #include <math.h>
 #include <complex>
+#include <algorithm>
 
 #include "metrics.h"
+#include "distance_kernels.h"
+#include "parallel_utility.h"
 
 namespace cph
 {
 
+	/*
+	 * The order in which the entries of a basic_matrix are stored: one row after
+	 * the other, or one column after the other as in R and Fortran.
+	 */
+	enum matrix_layout
+	{
+		row_major, column_major
+	};
+
+	/*
+	 * A dense matrix stored in a single buffer, aligned to a cache line, in row
+	 * or column major order. A matrix can also be a view of memory owned by
+	 * someone else, such as the column major buffer of an R matrix, which is
+	 * then neither copied nor freed and must outlive the view.
+	 *
+	 * The entries are not constructed, so T must be an arithmetic type.
+	 */
 	template<class T>
 	class basic_matrix
 	{
 	private:
-		T ** const _data;
+		static const std::size_t ALIGNMENT = 64;
+		static const std::size_t COPY_BLOCK = 64;
+
 		const std::size_t _rows, _columns;
+		const matrix_layout _layout;
+		const std::size_t _row_stride, _column_stride;
+
+		// the owned buffer, or 0 for a view, and its aligned start
+		char * const _allocation;
+		T * const _data;
+
 	public:
-		basic_matrix(const std::size_t rows, const std::size_t columns) :
-			_data(new T*[rows]), _rows(rows), _columns(columns)
+		basic_matrix(const std::size_t rows, const std::size_t columns, const matrix_layout layout = row_major) :
+			_rows(rows), _columns(columns), _layout(layout), _row_stride(layout == row_major ? columns : 1),
+					_column_stride(layout == row_major ? 1 : rows), _allocation(basic_matrix::allocate(rows * columns)),
+					_data(basic_matrix::align(_allocation))
 		{
-			for (std::size_t i = 0; i < _rows; ++i)
-			{
-				this->_data[i] = new T[_columns];
-			}
 		}
 
-		basic_matrix(const std::size_t rows, const std::size_t columns, const T initial_value) :
-			_data(new T*[rows]), _rows(rows), _columns(columns)
+		basic_matrix(const std::size_t rows, const std::size_t columns, const T initial_value, const matrix_layout layout = row_major) :
+			_rows(rows), _columns(columns), _layout(layout), _row_stride(layout == row_major ? columns : 1),
+					_column_stride(layout == row_major ? 1 : rows), _allocation(basic_matrix::allocate(rows * columns)),
+					_data(basic_matrix::align(_allocation))
+		{
+			std::fill(this->_data, this->_data + rows * columns, initial_value);
+		}
+
+		/*
+		 * A view of the rows x columns entries starting at data, in the given
+		 * layout.
+		 */
+		basic_matrix(T * data, const std::size_t rows, const std::size_t columns, const matrix_layout layout) :
+			_rows(rows), _columns(columns), _layout(layout), _row_stride(layout == row_major ? columns : 1),
+					_column_stride(layout == row_major ? 1 : rows), _allocation(0), _data(data)
 		{
-			for (std::size_t i = 0; i < _rows; ++i)
-			{
-				this->_data[i] = new T[_columns];
-				for (std::size_t j = 0; j < _columns; j++)
-				{
-					this->_data[i][j] = initial_value;
-				}
-			}
 		}
 
+		/*
+		 * A copy which owns its entries, in the same layout, even if other is a
+		 * view.
+		 */
 		basic_matrix(const basic_matrix<T> & other) :
-			_data(new T*[other._rows]), _rows(other._rows), _columns(other._columns)
+			_rows(other._rows), _columns(other._columns), _layout(other._layout), _row_stride(other._row_stride),
+					_column_stride(other._column_stride), _allocation(basic_matrix::allocate(other._rows * other._columns)),
+					_data(basic_matrix::align(_allocation))
 		{
-			for (std::size_t i = 0; i < _rows; ++i)
+			std::copy(other._data, other._data + this->_rows * this->_columns, this->_data);
+		}
+
+		/*
+		 * A copy in the given layout, transposed block by block when the layouts
+		 * differ.
+		 */
+		basic_matrix(const basic_matrix<T> & other, const matrix_layout layout) :
+			_rows(other._rows), _columns(other._columns), _layout(layout), _row_stride(layout == row_major ? other._columns : 1),
+					_column_stride(layout == row_major ? 1 : other._rows), _allocation(basic_matrix::allocate(other._rows * other._columns)),
+					_data(basic_matrix::align(_allocation))
+		{
+			if (layout == other._layout)
+			{
+				std::copy(other._data, other._data + this->_rows * this->_columns, this->_data);
+				return;
+			}
+
+			const std::size_t row_blocks = (this->_rows + COPY_BLOCK - 1) / COPY_BLOCK;
+
+			CPH_OMP(parallel for schedule(static))
+			for (std::size_t block = 0; block < row_blocks; block++)
 			{
-				this->_data[i] = new T[_columns];
-				for (std::size_t j = 0; j < _columns; j++)
+				const std::size_t row_begin = block * COPY_BLOCK;
+				const std::size_t row_end = (row_begin + COPY_BLOCK < this->_rows ? row_begin + COPY_BLOCK : this->_rows);
+
+				for (std::size_t column_begin = 0; column_begin < this->_columns; column_begin += COPY_BLOCK)
 				{
-					this->_data[i][j] = other._data[i][j];
+					const std::size_t column_end = (column_begin + COPY_BLOCK < this->_columns ? column_begin + COPY_BLOCK : this->_columns);
+					for (std::size_t i = row_begin; i < row_end; i++)
+					{
+						for (std::size_t j = column_begin; j < column_end; j++)
+						{
+							(*this)(i, j) = other(i, j);
+						}
+					}
 				}
 			}
 		}
 
 		virtual ~basic_matrix()
 		{
-			for (std::size_t i = 0; i < this->_rows; ++i)
-			{
-				delete[] (this->_data[i]);
-			}
-
-			delete[] (this->_data);
+			delete[] (this->_allocation);
 		}
 
 		const std::size_t rows() const
@@ -79,22 +142,60 @@ namespace cph
 			return this->_columns;
 		}
 
+		const matrix_layout layout() const
+		{
+			return this->_layout;
+		}
+
+		/*
+		 * Whether the entries belong to someone else.
+		 */
+		bool is_view() const
+		{
+			return (this->_allocation == 0);
+		}
+
+		/*
+		 * The entries, in the order of the layout.
+		 */
+		const T * data() const
+		{
+			return this->_data;
+		}
+
+		T * data()
+		{
+			return this->_data;
+		}
+
 		T & operator()(const std::size_t row, const std::size_t column)
 		{
-			return this->_data[row][column];
+			return this->_data[row * this->_row_stride + column * this->_column_stride];
 		}
 
 		const T operator()(const std::size_t row, const std::size_t column) const
 		{
-			return this->_data[row][column];
+			return this->_data[row * this->_row_stride + column * this->_column_stride];
+		}
+
+		/*
+		 * The first entry of row i. The row is contiguous in the row major layout,
+		 * and its entries are rows() apart in the column major one.
+		 */
+		const T * row(const std::size_t i) const
+		{
+			return this->_data + i * this->_row_stride;
 		}
 
 		const T row_norm(const std::size_t i) const
 		{
+			const T * x = this->row(i);
+			const std::size_t s = this->_column_stride;
+
 			T sum(0);
 			for (std::size_t k = 0; k < this->_columns; k++)
 			{
-				sum += _data[i][k] * _data[i][k];
+				sum += x[k * s] * x[k * s];
 			}
 
 			return std::sqrt(sum);
@@ -102,148 +203,55 @@ namespace cph
 
 		const T row_distance(const std::size_t i, const std::size_t j, const metric metric_type, const T p = 2) const
 		{
-			switch (metric_type)
-			{
-				case euclidean:
-					return row_euclidean_distance(i, j);
-				case maximum:
-					return row_maximum_distance(i, j);
-				case manhattan:
-					return row_manhattan_distance(i, j);
-				case canberra:
-					return row_canberra_distance(i, j);
-				case binary:
-					return row_binary_distance(i, j);
-				case minkowski:
-					return row_minkowski_distance(i, j, p);
-			}
+			return this->row_distance(i, j, this->distance_kernel(metric_type, p), p);
+		}
 
-			return 0;
+		/*
+		 * The function computing the distances between rows in the given metric,
+		 * for callers computing many distances, which then dispatch on the metric
+		 * only once. It is vectorized when the rows are contiguous.
+		 */
+		typename distance_kernels<T>::kernel_function distance_kernel(const metric metric_type, const T p = 2) const
+		{
+			return (this->_column_stride == 1 ? distance_kernels<T>::kernel(metric_type, p) : distance_kernels<T>::scalar_kernel(metric_type, p));
 		}
 
-		const T row_euclidean_distance(const std::size_t i, const std::size_t j) const
+		/*
+		 * The distance between rows i and j with a function from distance_kernel.
+		 */
+		const T row_distance(const std::size_t i, const std::size_t j, const typename distance_kernels<T>::kernel_function kernel, const T p = 2) const
 		{
-			T sum(0), distance(0);
-			for (std::size_t k = 0; k < this->_columns; k++)
-			{
-				distance = _data[i][k] - _data[j][k];
-				sum += distance * distance;
-			}
+			return kernel(this->row(i), this->row(j), this->_columns, this->_column_stride, p);
+		}
 
-			return std::sqrt(sum);
+		const T row_euclidean_distance(const std::size_t i, const std::size_t j) const
+		{
+			return this->row_distance(i, j, euclidean);
 		}
 
 		const T row_maximum_distance(const std::size_t i, const std::size_t j) const
 		{
-			T max(0), difference(0);
-			for (std::size_t k = 0; k < this->_columns; k++)
-			{
-				difference = _data[i][k] - _data[j][k];
-
-				if (difference < 0)
-				{
-					difference *= -1;
-				}
-
-				if (difference > max)
-				{
-					max = difference;
-				}
-			}
-
-			return max;
+			return this->row_distance(i, j, maximum);
 		}
 
 		const T row_manhattan_distance(const std::size_t i, const std::size_t j) const
 		{
-			T sum(0), difference(0);
-			for (std::size_t k = 0; k < this->_columns; k++)
-			{
-				difference = _data[i][k] - _data[j][k];
-
-				if (difference < 0)
-				{
-					difference *= -1;
-				}
-
-				sum += difference;
-			}
-
-			return sum;
+			return this->row_distance(i, j, manhattan);
 		}
 
 		const T row_minkowski_distance(const std::size_t i, const std::size_t j, const T p) const
 		{
-			T sum(0), difference(0);
-			for (std::size_t k = 0; k < this->_columns; k++)
-			{
-				difference = _data[i][k] - _data[j][k];
-
-				if (difference < 0)
-				{
-					difference *= -1;
-				}
-
-				sum += pow(difference, p);
-			}
-
-			return pow(difference, 1.0 / p);
+			return this->row_distance(i, j, minkowski, p);
 		}
 
 		const T row_canberra_distance(const std::size_t i, const std::size_t j) const
 		{
-			T sum(0), difference(0), row_sum(0);
-			for (std::size_t k = 0; k < this->_columns; k++)
-			{
-				difference = _data[i][k] - _data[j][k];
-				sum = _data[i][k] + _data[j][k];
-
-				if (difference < 0)
-				{
-					difference *= -1;
-				}
-
-				if (sum < 0)
-				{
-					sum *= -1;
-				}
-
-				if (sum != 0)
-				{
-					row_sum += difference / sum;
-				}
-			}
-
-			return row_sum;
+			return this->row_distance(i, j, canberra);
 		}
 
 		const T row_binary_distance(const std::size_t i, const std::size_t j) const
 		{
-			T numerator(0), denominator(0);
-			for (std::size_t k = 0; k < this->_columns; k++)
-			{
-				bool x = (_data[i][k] != 0);
-				bool y = (_data[j][k] != 0);
-
-				if (x || y)
-				{
-					denominator++;
-
-					if (x ^ y)
-					{
-						numerator++;
-					}
-				}
-			}
-
-			if (denominator > 0)
-			{
-				return numerator / denominator;
-			}
-			else
-			{
-				return 0;
-			}
+			return this->row_distance(i, j, binary);
 		}
 
 		template<class S>
@@ -272,6 +280,20 @@ namespace cph
 
 			return s;
 		}
+
+	private:
+		basic_matrix<T> & operator=(const basic_matrix<T> &);
+
+		static char * allocate(const std::size_t size)
+		{
+			return new char[size * sizeof(T) + ALIGNMENT];
+		}
+
+		static T * align(char * allocation)
+		{
+			const std::size_t offset = reinterpret_cast<std::size_t> (allocation) % ALIGNMENT;
+			return reinterpret_cast<T *> (allocation + (ALIGNMENT - offset) % ALIGNMENT);
+		}
 	};
 
 }
@@ -0,0 +1,213 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef BITSET_GRAPH_H_
+#define BITSET_GRAPH_H_
+
+#include <vector>
+
+#include "weighted_edge.h"
+
+namespace cph
+{
+
+	/*
+	 * Operations on bitsets stored as arrays of 64-bit words, where bit b of
+	 * word w stands for the element 64 w + b.
+	 */
+	class word_bitset
+	{
+	private:
+		word_bitset()
+		{
+		}
+
+	public:
+		typedef unsigned long long word;
+
+		static const std::size_t WORD_BITS = 64;
+
+		virtual ~word_bitset()
+		{
+		}
+
+		static std::size_t word_count(const std::size_t size)
+		{
+			return (size + WORD_BITS - 1) / WORD_BITS;
+		}
+
+		/*
+		 * result = a & b over the first size words, returning whether the result
+		 * is non-empty. The loop has no dependencies between iterations, so that
+		 * the compiler can vectorize it.
+		 */
+		static bool intersect(const word * a, const word * b, const std::size_t size, word * result)
+		{
+			word any(0);
+			for (std::size_t w = 0; w < size; w++)
+			{
+				result[w] = a[w] & b[w];
+				any |= result[w];
+			}
+			return (any != 0);
+		}
+
+		static std::size_t count(const word * bits, const std::size_t size)
+		{
+			std::size_t result(0);
+			for (std::size_t w = 0; w < size; w++)
+			{
+				result += word_bitset::popcount(bits[w]);
+			}
+			return result;
+		}
+
+		static inline std::size_t popcount(word x)
+		{
+#ifdef __GNUC__
+			return __builtin_popcountll(x);
+#else
+			std::size_t result(0);
+			for (; x != 0; x &= x - 1)
+			{
+				result++;
+			}
+			return result;
+#endif
+		}
+
+		static inline std::size_t lowest_bit(const word x)
+		{
+#ifdef __GNUC__
+			return __builtin_ctzll(x);
+#else
+			std::size_t result(0);
+			while (((x >> result) & 1) == 0)
+			{
+				result++;
+			}
+			return result;
+#endif
+		}
+	};
+
+	/*
+	 * Weighted graph stored as a lower triangular bit matrix: row y has a bit
+	 * for every vertex x < y, set when [xy] is an edge. The weights are kept in a
+	 * separate dense lower triangular array.
+	 *
+	 * This costs O(n^2) memory independently of the number of edges, and pays off
+	 * when the graph is dense: intersecting two neighborhoods is a word-wise AND
+	 * rather than a merge.
+	 */
+	template<class W>
+	class bitset_graph
+	{
+	public:
+		typedef word_bitset::word word;
+		// element type of the arrays returned by lower_neighbors
+		typedef word neighbor_set_element;
+
+	private:
+		static const double DENSITY_THRESHOLD;
+		static const double MAX_DENSE_BYTES;
+
+		std::size_t _vertex_count;
+		std::size_t _row_words;
+		std::vector<word> _bits;
+		std::vector<W> _weights;
+		std::vector<std::size_t> _lower_degrees;
+
+	public:
+		bitset_graph(const std::vector<weighted_edge<W> > & edges, const std::size_t vertex_count) :
+			_vertex_count(vertex_count), _row_words(word_bitset::word_count(vertex_count)), _bits(vertex_count * _row_words, 0),
+					_weights(vertex_count * (vertex_count - (vertex_count > 0)) / 2, W(0)), _lower_degrees(vertex_count, 0)
+		{
+			for (typename std::vector<weighted_edge<W> >::const_iterator iter = edges.begin(); iter != edges.end(); iter++)
+			{
+				this->_bits[iter->j * this->_row_words + iter->i / word_bitset::WORD_BITS] |= (word(1) << (iter->i % word_bitset::WORD_BITS));
+				this->_weights[bitset_graph::weight_index(iter->i, iter->j)] = iter->weight;
+				this->_lower_degrees[iter->j]++;
+			}
+		}
+
+		virtual ~bitset_graph()
+		{
+		}
+
+		/*
+		 * Whether a graph with the given number of edges on the given number of
+		 * vertices is dense enough for the bit matrix to beat sorted neighbor
+		 * lists. In timings the bit matrix wins from a few percent of all possible
+		 * edges on; the threshold is set somewhat higher, and the bit matrix is
+		 * not used when its memory would be large both in absolute terms and
+		 * compared to the sparse representation.
+		 */
+		static bool is_dense(const std::size_t edge_count, const std::size_t vertex_count)
+		{
+			if (vertex_count < word_bitset::WORD_BITS)
+			{
+				return false;
+			}
+
+			const double possible_edges = 0.5 * double(vertex_count) * double(vertex_count - 1);
+			const double dense_bytes = possible_edges * sizeof(W) + double(vertex_count) * double(vertex_count) / 8;
+			const double sparse_bytes = double(edge_count) * (sizeof(W) + sizeof(std::size_t));
+
+			return (double(edge_count) >= DENSITY_THRESHOLD * possible_edges && (dense_bytes <= MAX_DENSE_BYTES || dense_bytes <= 2 * sparse_bytes));
+		}
+
+		std::size_t vertex_count() const
+		{
+			return this->_vertex_count;
+		}
+
+		const W get_weight(const std::size_t & i, const std::size_t & j) const
+		{
+			return this->_weights[bitset_graph::weight_index(i < j ? i : j, i < j ? j : i)];
+		}
+
+		/*
+		 * The lower neighbors of y, as a bitset of lower_neighbors_size(y) words.
+		 */
+		const word * lower_neighbors(const std::size_t & y) const
+		{
+			return &this->_bits[y * this->_row_words];
+		}
+
+		std::size_t lower_neighbors_size(const std::size_t & y) const
+		{
+			return word_bitset::word_count(y);
+		}
+
+		std::size_t max_lower_neighbors_size() const
+		{
+			return this->_row_words;
+		}
+
+		std::size_t lower_degree(const std::size_t & y) const
+		{
+			return this->_lower_degrees[y];
+		}
+
+	private:
+		static inline std::size_t weight_index(const std::size_t x, const std::size_t y)
+		{
+			return y * (y - 1) / 2 + x;
+		}
+	};
+
+	template<class W>
+	const double bitset_graph<W>::DENSITY_THRESHOLD = 1.0 / 16;
+
+	template<class W>
+	const double bitset_graph<W>::MAX_DENSE_BYTES = 256.0 * 1024 * 1024;
+
+}
+
+#endif /* BITSET_GRAPH_H_ */
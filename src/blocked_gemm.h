@@ -0,0 +1,290 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef BLOCKED_GEMM_H_
+#define BLOCKED_GEMM_H_
+
+#include <vector>
+#include <algorithm>
+
+#include "distance_kernels.h"
+
+namespace cph
+{
+
+	/*
+	 * A small matrix multiplication kernel computing the dot products between
+	 * two sets of vectors, the product X Y^T, without depending on a BLAS.
+	 *
+	 * The inner dimension is processed in blocks of DEPTH_BLOCK coordinates. For
+	 * each block, the vectors are copied into panels of MR vectors of X and NR
+	 * vectors of Y, interleaved coordinate by coordinate and padded with zeros,
+	 * and a micro kernel accumulates the MR x NR dot products of two panels in
+	 * registers. A panel of Y is reused against all the panels of X while it
+	 * stays in the L1 cache.
+	 *
+	 * As in distance_kernels, the micro kernels for double precision use AVX2
+	 * or AVX-512 when the processor has them, and sum in a different order than
+	 * the scalar kernel. The callers compute one block of moderate size per
+	 * thread, so the multiplication itself is serial.
+	 */
+	template<class T>
+	class blocked_gemm
+	{
+	private:
+		blocked_gemm()
+		{
+		}
+
+		// the largest MR x NR of the micro kernels
+		static const std::size_t MAX_TILE = 64;
+
+		typedef void (*micro_kernel_function)(const std::size_t depth, const T * x, const T * y, T * tile);
+
+	public:
+		static const std::size_t DEPTH_BLOCK = 256;
+
+		virtual ~blocked_gemm()
+		{
+		}
+
+		/*
+		 * Writes the dot products of x[r] - shift and y[c] - shift to
+		 * result[r * n + c], for r < m and c < n, where the vectors x[r] and
+		 * y[c] have depth contiguous coordinates. The shift may be 0.
+		 */
+		static void multiply(const T * const * x, const std::size_t m, const T * const * y, const std::size_t n, const std::size_t depth,
+				const T * shift, T * result)
+		{
+			std::size_t mr(0), nr(0);
+			const micro_kernel_function micro_kernel = blocked_gemm::select_micro_kernel(mr, nr);
+
+			std::fill(result, result + m * n, T(0));
+			if (m == 0 || n == 0)
+			{
+				return;
+			}
+
+			const std::size_t row_panels = (m + mr - 1) / mr;
+			const std::size_t column_panels = (n + nr - 1) / nr;
+			std::vector<T> packed_x(row_panels * mr * std::min(depth, std::size_t(DEPTH_BLOCK)));
+			std::vector<T> packed_y(column_panels * nr * std::min(depth, std::size_t(DEPTH_BLOCK)));
+			T tile[MAX_TILE];
+
+			for (std::size_t depth_begin = 0; depth_begin < depth; depth_begin += DEPTH_BLOCK)
+			{
+				const std::size_t block_depth = std::min(depth - depth_begin, std::size_t(DEPTH_BLOCK));
+				blocked_gemm::pack(x, m, mr, depth_begin, block_depth, shift, &packed_x[0]);
+				blocked_gemm::pack(y, n, nr, depth_begin, block_depth, shift, &packed_y[0]);
+
+				for (std::size_t column_panel = 0; column_panel < column_panels; column_panel++)
+				{
+					const std::size_t column_begin = column_panel * nr;
+					const std::size_t column_count = std::min(n - column_begin, nr);
+
+					for (std::size_t row_panel = 0; row_panel < row_panels; row_panel++)
+					{
+						const std::size_t row_begin = row_panel * mr;
+						const std::size_t row_count = std::min(m - row_begin, mr);
+
+						micro_kernel(block_depth, &packed_x[row_begin * block_depth], &packed_y[column_begin * block_depth], tile);
+
+						for (std::size_t r = 0; r < row_count; r++)
+						{
+							T * target = result + (row_begin + r) * n + column_begin;
+							for (std::size_t c = 0; c < column_count; c++)
+							{
+								target[c] += tile[r * nr + c];
+							}
+						}
+					}
+				}
+			}
+		}
+
+		/*
+		 * The name of the instruction set of the micro kernel.
+		 */
+		static const char * instruction_set()
+		{
+			return "scalar";
+		}
+
+	private:
+		/*
+		 * Copies coordinates depth_begin, ..., depth_begin + block_depth - 1 of
+		 * the vectors into panels of width vectors, panel p holding the
+		 * coordinate k of vector p * width + w at (p * block_depth + k) * width + w.
+		 */
+		static void pack(const T * const * vectors, const std::size_t count, const std::size_t width, const std::size_t depth_begin,
+				const std::size_t block_depth, const T * shift, T * packed)
+		{
+			const std::size_t panels = (count + width - 1) / width;
+
+			for (std::size_t panel = 0; panel < panels; panel++)
+			{
+				T * target = packed + panel * block_depth * width;
+				for (std::size_t w = 0; w < width; w++)
+				{
+					const std::size_t index = panel * width + w;
+					if (index >= count)
+					{
+						for (std::size_t k = 0; k < block_depth; k++)
+						{
+							target[k * width + w] = T(0);
+						}
+						continue;
+					}
+
+					const T * source = vectors[index] + depth_begin;
+					for (std::size_t k = 0; k < block_depth; k++)
+					{
+						target[k * width + w] = (shift == 0 ? source[k] : source[k] - shift[depth_begin + k]);
+					}
+				}
+			}
+		}
+
+		static micro_kernel_function select_micro_kernel(std::size_t & mr, std::size_t & nr)
+		{
+			mr = 4;
+			nr = 4;
+			return &blocked_gemm::scalar_micro_kernel;
+		}
+
+		static void scalar_micro_kernel(const std::size_t depth, const T * x, const T * y, T * tile)
+		{
+			T sums[16] = { T(0) };
+
+			for (std::size_t k = 0; k < depth; k++)
+			{
+				for (std::size_t r = 0; r < 4; r++)
+				{
+					const T a = x[4 * k + r];
+					for (std::size_t c = 0; c < 4; c++)
+					{
+						sums[4 * r + c] += a * y[4 * k + c];
+					}
+				}
+			}
+
+			std::copy(sums, sums + 16, tile);
+		}
+
+#ifdef CPH_DISTANCE_DISPATCH
+		/*
+		 * 4 x 8 dot products in eight AVX2 registers.
+		 */
+		CPH_TARGET_AVX2 static void micro_kernel_avx2(const std::size_t depth, const double * x, const double * y, double * tile)
+		{
+			__m256d sum_00 = _mm256_setzero_pd(), sum_01 = _mm256_setzero_pd();
+			__m256d sum_10 = _mm256_setzero_pd(), sum_11 = _mm256_setzero_pd();
+			__m256d sum_20 = _mm256_setzero_pd(), sum_21 = _mm256_setzero_pd();
+			__m256d sum_30 = _mm256_setzero_pd(), sum_31 = _mm256_setzero_pd();
+
+			for (std::size_t k = 0; k < depth; k++)
+			{
+				const __m256d b_0 = _mm256_loadu_pd(y + 8 * k);
+				const __m256d b_1 = _mm256_loadu_pd(y + 8 * k + 4);
+				const double * a = x + 4 * k;
+
+				__m256d a_r = _mm256_broadcast_sd(a);
+				sum_00 = _mm256_fmadd_pd(a_r, b_0, sum_00);
+				sum_01 = _mm256_fmadd_pd(a_r, b_1, sum_01);
+				a_r = _mm256_broadcast_sd(a + 1);
+				sum_10 = _mm256_fmadd_pd(a_r, b_0, sum_10);
+				sum_11 = _mm256_fmadd_pd(a_r, b_1, sum_11);
+				a_r = _mm256_broadcast_sd(a + 2);
+				sum_20 = _mm256_fmadd_pd(a_r, b_0, sum_20);
+				sum_21 = _mm256_fmadd_pd(a_r, b_1, sum_21);
+				a_r = _mm256_broadcast_sd(a + 3);
+				sum_30 = _mm256_fmadd_pd(a_r, b_0, sum_30);
+				sum_31 = _mm256_fmadd_pd(a_r, b_1, sum_31);
+			}
+
+			_mm256_storeu_pd(tile, sum_00);
+			_mm256_storeu_pd(tile + 4, sum_01);
+			_mm256_storeu_pd(tile + 8, sum_10);
+			_mm256_storeu_pd(tile + 12, sum_11);
+			_mm256_storeu_pd(tile + 16, sum_20);
+			_mm256_storeu_pd(tile + 20, sum_21);
+			_mm256_storeu_pd(tile + 24, sum_30);
+			_mm256_storeu_pd(tile + 28, sum_31);
+		}
+
+		/*
+		 * 4 x 16 dot products in eight AVX-512 registers.
+		 */
+		CPH_TARGET_AVX512 static void micro_kernel_avx512(const std::size_t depth, const double * x, const double * y, double * tile)
+		{
+			__m512d sum_00 = _mm512_setzero_pd(), sum_01 = _mm512_setzero_pd();
+			__m512d sum_10 = _mm512_setzero_pd(), sum_11 = _mm512_setzero_pd();
+			__m512d sum_20 = _mm512_setzero_pd(), sum_21 = _mm512_setzero_pd();
+			__m512d sum_30 = _mm512_setzero_pd(), sum_31 = _mm512_setzero_pd();
+
+			for (std::size_t k = 0; k < depth; k++)
+			{
+				const __m512d b_0 = _mm512_loadu_pd(y + 16 * k);
+				const __m512d b_1 = _mm512_loadu_pd(y + 16 * k + 8);
+				const double * a = x + 4 * k;
+
+				__m512d a_r = _mm512_set1_pd(a[0]);
+				sum_00 = _mm512_fmadd_pd(a_r, b_0, sum_00);
+				sum_01 = _mm512_fmadd_pd(a_r, b_1, sum_01);
+				a_r = _mm512_set1_pd(a[1]);
+				sum_10 = _mm512_fmadd_pd(a_r, b_0, sum_10);
+				sum_11 = _mm512_fmadd_pd(a_r, b_1, sum_11);
+				a_r = _mm512_set1_pd(a[2]);
+				sum_20 = _mm512_fmadd_pd(a_r, b_0, sum_20);
+				sum_21 = _mm512_fmadd_pd(a_r, b_1, sum_21);
+				a_r = _mm512_set1_pd(a[3]);
+				sum_30 = _mm512_fmadd_pd(a_r, b_0, sum_30);
+				sum_31 = _mm512_fmadd_pd(a_r, b_1, sum_31);
+			}
+
+			_mm512_storeu_pd(tile, sum_00);
+			_mm512_storeu_pd(tile + 8, sum_01);
+			_mm512_storeu_pd(tile + 16, sum_10);
+			_mm512_storeu_pd(tile + 24, sum_11);
+			_mm512_storeu_pd(tile + 32, sum_20);
+			_mm512_storeu_pd(tile + 40, sum_21);
+			_mm512_storeu_pd(tile + 48, sum_30);
+			_mm512_storeu_pd(tile + 56, sum_31);
+		}
+#endif
+	};
+
+#ifdef CPH_DISTANCE_DISPATCH
+	template<>
+	inline blocked_gemm<double>::micro_kernel_function blocked_gemm<double>::select_micro_kernel(std::size_t & mr, std::size_t & nr)
+	{
+		mr = 4;
+		switch (distance_kernels<double>::level())
+		{
+			case distance_kernels<double>::AVX512:
+				nr = 16;
+				return &blocked_gemm::micro_kernel_avx512;
+			case distance_kernels<double>::AVX2:
+				nr = 8;
+				return &blocked_gemm::micro_kernel_avx2;
+			default:
+				nr = 4;
+				return &blocked_gemm::scalar_micro_kernel;
+		}
+	}
+
+	template<>
+	inline const char * blocked_gemm<double>::instruction_set()
+	{
+		return distance_kernels<double>::instruction_set();
+	}
+#endif
+
+}
+
+#endif /* BLOCKED_GEMM_H_ */
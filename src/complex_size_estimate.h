@@ -0,0 +1,56 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef COMPLEX_SIZE_ESTIMATE_H_
+#define COMPLEX_SIZE_ESTIMATE_H_
+
+#include <vector>
+#include <cstddef>
+
+namespace cph
+{
+
+	/*
+	 * The (exact or estimated) number of simplices in each dimension of a
+	 * filtered complex, together with the projected number of bytes needed to
+	 * construct it and to compute its persistent homology.
+	 */
+	struct complex_size_estimate
+	{
+		std::vector<double> simplices;
+		double construction_memory;
+		double reduction_memory;
+
+		// approximate per-allocation costs used by the memory projections
+		static const std::size_t HEAP_OVERHEAD = 16;
+		static const std::size_t TREE_NODE_OVERHEAD = 32;
+
+		complex_size_estimate() :
+			construction_memory(0), reduction_memory(0)
+		{
+		}
+
+		double total_simplices() const
+		{
+			double total(0);
+			for (std::size_t d = 0; d < simplices.size(); d++)
+			{
+				total += simplices[d];
+			}
+			return total;
+		}
+
+		double total_memory() const
+		{
+			return construction_memory + reduction_memory;
+		}
+	};
+
+}
+
+#endif /* COMPLEX_SIZE_ESTIMATE_H_ */
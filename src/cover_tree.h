@@ -0,0 +1,175 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef COVER_TREE_H_
+#define COVER_TREE_H_
+
+#include <vector>
+#include <cmath>
+
+#include "finite_metric_space.h"
+#include "pairwise_distances.h"
+
+namespace cph
+{
+
+	/*
+	 * A cover tree over a growing subset of the points of a finite metric space,
+	 * in the simplified form of Izbicki and Shelton, "Faster cover trees". Each
+	 * node has a level l and a covering distance 2^l; its children have level
+	 * l - 1, lie within 2^l of it and are more than 2^(l - 1) apart from each
+	 * other, so that all the descendants of a node lie within 2^(l + 1) of it.
+	 *
+	 * The root is given its level from the distances to all the points, so that
+	 * it covers every point which may be inserted and never has to be raised.
+	 * For metrics with a bounded expansion constant, insertions and queries take
+	 * O(log n) distances.
+	 *
+	 * As in spatial_index, the pruning bounds get a small relative slack, and
+	 * distances are computed as distance(i, j) with i < j.
+	 */
+	template<class T>
+	class cover_tree
+	{
+	private:
+		// relative slack added to the pruning bounds
+		static const double TOLERANCE;
+
+		struct node
+		{
+			std::size_t point;
+			int level;
+			std::vector<std::size_t> children;
+
+			node(const std::size_t point, const int level) :
+				point(point), level(level)
+			{
+			}
+		};
+
+		const finite_metric_space<T> & _metric_space;
+		std::vector<node> _nodes;
+
+	public:
+		/*
+		 * Creates a tree holding only the root point, which must be a point of a
+		 * non empty metric space.
+		 */
+		cover_tree(const finite_metric_space<T> & metric_space, const std::size_t root) :
+			_metric_space(metric_space)
+		{
+			std::vector<T> distances;
+			pairwise_distances::distance_row(metric_space, root, distances);
+
+			T radius(0);
+			for (std::size_t j = 0; j < distances.size(); j++)
+			{
+				radius = (distances[j] > radius ? distances[j] : radius);
+			}
+
+			// 2^level is the first power of 2 above the largest distance
+			int level(0);
+			std::frexp(radius, &level);
+
+			this->_nodes.push_back(node(root, level));
+		}
+
+		virtual ~cover_tree()
+		{
+		}
+
+		std::size_t size() const
+		{
+			return this->_nodes.size();
+		}
+
+		/*
+		 * Adds point x, which must not be in the tree, as a child of the lowest
+		 * node covering it.
+		 */
+		void insert(const std::size_t x)
+		{
+			std::size_t current(0);
+
+			bool descended(true);
+			while (descended)
+			{
+				descended = false;
+				const std::vector<std::size_t> & children = this->_nodes[current].children;
+				for (std::vector<std::size_t>::const_iterator iter = children.begin(); iter != children.end(); iter++)
+				{
+					if (this->distance(x, this->_nodes[*iter].point) <= this->covering_distance(*iter))
+					{
+						current = *iter;
+						descended = true;
+						break;
+					}
+				}
+			}
+
+			const int level = this->_nodes[current].level - 1;
+			this->_nodes[current].children.push_back(this->_nodes.size());
+			this->_nodes.push_back(node(x, level));
+		}
+
+		/*
+		 * Whether some point of the tree lies within the given radius of point x.
+		 * A subtree is skipped when the ball around x misses the ball of twice the
+		 * covering distance around its root.
+		 */
+		bool covers(const std::size_t x, const T radius) const
+		{
+			if (this->distance(x, this->_nodes[0].point) <= radius)
+			{
+				return true;
+			}
+
+			std::vector<std::size_t> stack(1, 0);
+			while (!stack.empty())
+			{
+				const std::size_t current = stack.back();
+				stack.pop_back();
+
+				const std::vector<std::size_t> & children = this->_nodes[current].children;
+				for (std::vector<std::size_t>::const_iterator iter = children.begin(); iter != children.end(); iter++)
+				{
+					const T d = this->distance(x, this->_nodes[*iter].point);
+					if (d <= radius)
+					{
+						return true;
+					}
+
+					const T bound = radius + 2 * this->covering_distance(*iter);
+					if (d <= bound + T(TOLERANCE * (d + bound)))
+					{
+						stack.push_back(*iter);
+					}
+				}
+			}
+
+			return false;
+		}
+
+	private:
+		inline T covering_distance(const std::size_t k) const
+		{
+			return std::ldexp(T(1), this->_nodes[k].level);
+		}
+
+		inline T distance(const std::size_t i, const std::size_t j) const
+		{
+			return (i == j ? T(0) : i < j ? this->_metric_space.distance(i, j) : this->_metric_space.distance(j, i));
+		}
+	};
+
+	template<class T>
+	const double cover_tree<T>::TOLERANCE = 1e-10;
+
+}
+
+#endif /* COVER_TREE_H_ */
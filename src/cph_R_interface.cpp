@@ -16,26 +16,77 @@
 #include <Rcpp.h>
 #include <vector>
 
+/*
+ * Wraps the column major buffer of an R matrix without copying it. The view
+ * does not free the buffer, which R keeps alive for the duration of the call.
+ */
+static cph::basic_matrix<double> * matrix_view(Rcpp::NumericMatrix & X_R)
+{
+	return new cph::basic_matrix<double>(X_R.begin(), X_R.nrow(), X_R.ncol(), cph::column_major);
+}
+
+/*
+ * Copies an R matrix of points into row major order in one blocked pass, so
+ * that the distance kernels read each point from contiguous memory.
+ */
+static cph::basic_matrix<double> * row_major_copy(Rcpp::NumericMatrix & X_R)
+{
+	const cph::basic_matrix<double> view(X_R.begin(), X_R.nrow(), X_R.ncol(), cph::column_major);
+	return new cph::basic_matrix<double>(view, cph::row_major);
+}
+
+static SEXP size_estimate_to_R(const cph::complex_size_estimate & estimate)
+{
+	Rcpp::NumericVector simplices_R(estimate.simplices.size());
+
+	for (std::size_t d(0); d < estimate.simplices.size(); d++)
+	{
+		simplices_R[d] = estimate.simplices[d];
+	}
+
+	return Rcpp::List::create(Rcpp::Named("simplices") = simplices_R, Rcpp::Named("construction_memory") = estimate.construction_memory,
+			Rcpp::Named("reduction_memory") = estimate.reduction_memory);
+}
+
 SEXP default_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power)
 {
 	Rcpp::NumericMatrix X_R(_matrix);
 
 	int dimension = Rcpp::as<int>(_dimension);
 	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
-	cph::basic_matrix<double> * X = new cph::basic_matrix<double>(X_R.nrow(), X_R.ncol());
+	cph::basic_matrix<double> * X = row_major_copy(X_R);
 
 	cph::metric metric_type = (cph::metric) Rcpp::as<int>(_metric_type);
 	double p = Rcpp::as<double>(_power);
 
-	for (int i(0); i < X_R.nrow(); i++)
+	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
+	cph::barcode_collection<double> intervals = cph::default_persistent_homology(metric_space, dimension, max_filtration_value);
+	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
+	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
+
+	for (std::size_t i(0); i < endpoint_matrix.rows(); i++)
 	{
-		for (int j(0); j < X_R.ncol(); j++)
+		for (std::size_t j(0); j < endpoint_matrix.columns(); j++)
 		{
-			(*X)(i, j) = X_R(i, j);
+			endpoint_matrix_R(i, j) = endpoint_matrix.operator()(i, j);
 		}
 	}
 
-	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
+	// NB: we don't have to delete X since metric_space will delete it
+	// delete (X);
+
+	return endpoint_matrix_R;
+}
+
+SEXP default_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value)
+{
+	Rcpp::NumericMatrix X_R(_matrix);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	cph::basic_matrix<double> * X = matrix_view(X_R);
+
+	cph::explicit_metric_space<double> metric_space(X);
 	cph::barcode_collection<double> intervals = cph::default_persistent_homology(metric_space, dimension, max_filtration_value);
 	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
 	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
@@ -54,24 +105,63 @@ SEXP default_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_
 	return endpoint_matrix_R;
 }
 
-SEXP default_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value)
+SEXP vr_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power, SEXP _collapse_edges,
+		SEXP _spatial_index, SEXP _pipelined)
 {
 	Rcpp::NumericMatrix X_R(_matrix);
 
 	int dimension = Rcpp::as<int>(_dimension);
 	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
-	cph::basic_matrix<double> * X = new cph::basic_matrix<double>(X_R.nrow(), X_R.ncol());
+	bool collapse_edges = Rcpp::as<bool>(_collapse_edges);
+	bool spatial_index = Rcpp::as<bool>(_spatial_index);
+	bool pipelined = Rcpp::as<bool>(_pipelined);
+	cph::basic_matrix<double> * X = row_major_copy(X_R);
+
+	cph::metric metric_type = (cph::metric) Rcpp::as<int>(_metric_type);
+	double p = Rcpp::as<double>(_power);
 
-	for (int i(0); i < X_R.nrow(); i++)
+	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
+	double effective_max_filtration_value(max_filtration_value);
+	cph::barcode_collection<double> intervals = cph::vr_persistent_homology(metric_space, dimension, max_filtration_value, collapse_edges, pipelined,
+			spatial_index, &effective_max_filtration_value);
+	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
+	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
+
+	for (std::size_t i(0); i < endpoint_matrix.rows(); i++)
 	{
-		for (int j(0); j < X_R.ncol(); j++)
+		for (std::size_t j(0); j < endpoint_matrix.columns(); j++)
 		{
-			(*X)(i, j) = X_R(i, j);
+			endpoint_matrix_R(i, j) = endpoint_matrix.operator()(i, j);
 		}
 	}
 
+	// report the threshold actually used when it was capped at the enclosing radius
+	if (effective_max_filtration_value < max_filtration_value)
+	{
+		endpoint_matrix_R.attr("enclosing_radius") = effective_max_filtration_value;
+	}
+
+	// NB: we don't have to delete X since metric_space will delete it
+	// delete (X);
+
+	return endpoint_matrix_R;
+}
+
+SEXP vr_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _collapse_edges, SEXP _spatial_index, SEXP _pipelined)
+{
+	Rcpp::NumericMatrix X_R(_matrix);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	bool collapse_edges = Rcpp::as<bool>(_collapse_edges);
+	bool spatial_index = Rcpp::as<bool>(_spatial_index);
+	bool pipelined = Rcpp::as<bool>(_pipelined);
+	cph::basic_matrix<double> * X = matrix_view(X_R);
+
 	cph::explicit_metric_space<double> metric_space(X);
-	cph::barcode_collection<double> intervals = cph::default_persistent_homology(metric_space, dimension, max_filtration_value);
+	double effective_max_filtration_value(max_filtration_value);
+	cph::barcode_collection<double> intervals = cph::vr_persistent_homology(metric_space, dimension, max_filtration_value, collapse_edges, pipelined,
+			spatial_index, &effective_max_filtration_value);
 	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
 	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
 
@@ -83,33 +173,60 @@ SEXP default_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_val
 		}
 	}
 
+	// report the threshold actually used when it was capped at the enclosing radius
+	if (effective_max_filtration_value < max_filtration_value)
+	{
+		endpoint_matrix_R.attr("enclosing_radius") = effective_max_filtration_value;
+	}
+
 	// NB: we don't have to delete X since metric_space will delete it
 	// delete (X);
 
 	return endpoint_matrix_R;
 }
 
-SEXP vr_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power)
+SEXP sparse_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power, SEXP _epsilon)
 {
 	Rcpp::NumericMatrix X_R(_matrix);
 
 	int dimension = Rcpp::as<int>(_dimension);
 	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
-	cph::basic_matrix<double> * X = new cph::basic_matrix<double>(X_R.nrow(), X_R.ncol());
+	double epsilon = Rcpp::as<double>(_epsilon);
+	cph::basic_matrix<double> * X = row_major_copy(X_R);
 
 	cph::metric metric_type = (cph::metric) Rcpp::as<int>(_metric_type);
 	double p = Rcpp::as<double>(_power);
 
-	for (int i(0); i < X_R.nrow(); i++)
+	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
+	cph::barcode_collection<double> intervals = cph::sparse_rips_persistent_homology(metric_space, dimension, max_filtration_value, epsilon);
+	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
+	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
+
+	for (std::size_t i(0); i < endpoint_matrix.rows(); i++)
 	{
-		for (int j(0); j < X_R.ncol(); j++)
+		for (std::size_t j(0); j < endpoint_matrix.columns(); j++)
 		{
-			(*X)(i, j) = X_R(i, j);
+			endpoint_matrix_R(i, j) = endpoint_matrix.operator()(i, j);
 		}
 	}
 
-	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
-	cph::barcode_collection<double> intervals = cph::vr_persistent_homology(metric_space, dimension, max_filtration_value);
+	// NB: we don't have to delete X since metric_space will delete it
+	// delete (X);
+
+	return endpoint_matrix_R;
+}
+
+SEXP sparse_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _epsilon)
+{
+	Rcpp::NumericMatrix X_R(_matrix);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	double epsilon = Rcpp::as<double>(_epsilon);
+	cph::basic_matrix<double> * X = matrix_view(X_R);
+
+	cph::explicit_metric_space<double> metric_space(X);
+	cph::barcode_collection<double> intervals = cph::sparse_rips_persistent_homology(metric_space, dimension, max_filtration_value, epsilon);
 	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
 	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
 
@@ -127,24 +244,48 @@ SEXP vr_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value
 	return endpoint_matrix_R;
 }
 
-SEXP vr_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value)
+SEXP dtm_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power, SEXP _neighbors)
 {
 	Rcpp::NumericMatrix X_R(_matrix);
 
 	int dimension = Rcpp::as<int>(_dimension);
 	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
-	cph::basic_matrix<double> * X = new cph::basic_matrix<double>(X_R.nrow(), X_R.ncol());
+	int neighbors = Rcpp::as<int>(_neighbors);
+	cph::basic_matrix<double> * X = row_major_copy(X_R);
+
+	cph::metric metric_type = (cph::metric) Rcpp::as<int>(_metric_type);
+	double p = Rcpp::as<double>(_power);
+
+	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
+	cph::barcode_collection<double> intervals = cph::dtm_persistent_homology(metric_space, dimension, max_filtration_value, neighbors);
+	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
+	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
 
-	for (int i(0); i < X_R.nrow(); i++)
+	for (std::size_t i(0); i < endpoint_matrix.rows(); i++)
 	{
-		for (int j(0); j < X_R.ncol(); j++)
+		for (std::size_t j(0); j < endpoint_matrix.columns(); j++)
 		{
-			(*X)(i, j) = X_R(i, j);
+			endpoint_matrix_R(i, j) = endpoint_matrix.operator()(i, j);
 		}
 	}
 
+	// NB: we don't have to delete X since metric_space will delete it
+	// delete (X);
+
+	return endpoint_matrix_R;
+}
+
+SEXP dtm_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _neighbors)
+{
+	Rcpp::NumericMatrix X_R(_matrix);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	int neighbors = Rcpp::as<int>(_neighbors);
+	cph::basic_matrix<double> * X = matrix_view(X_R);
+
 	cph::explicit_metric_space<double> metric_space(X);
-	cph::barcode_collection<double> intervals = cph::vr_persistent_homology(metric_space, dimension, max_filtration_value);
+	cph::barcode_collection<double> intervals = cph::dtm_persistent_homology(metric_space, dimension, max_filtration_value, neighbors);
 	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
 	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
 
@@ -162,30 +303,50 @@ SEXP vr_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value)
 	return endpoint_matrix_R;
 }
 
-SEXP lw_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _metric_type, SEXP _power)
+SEXP alpha_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value)
 {
 	Rcpp::NumericMatrix X_R(_matrix);
 
 	int dimension = Rcpp::as<int>(_dimension);
 	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
-	int landmark_set_size = Rcpp::as<int>(_landmark_set_size);
-	int maxmin_sample_size = Rcpp::as<int>(_maxmin_sample_size);
-	cph::basic_matrix<double> * X = new cph::basic_matrix<double>(X_R.nrow(), X_R.ncol());
+	cph::basic_matrix<double> * X = matrix_view(X_R);
 
-	cph::metric metric_type = (cph::metric) Rcpp::as<int>(_metric_type);
-	double p = Rcpp::as<double>(_power);
+	cph::euclidean_metric_space<double> metric_space(X);
+	cph::barcode_collection<double> intervals = cph::alpha_persistent_homology(metric_space, dimension, max_filtration_value);
+	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
+	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
 
-	for (int i(0); i < X_R.nrow(); i++)
+	for (std::size_t i(0); i < endpoint_matrix.rows(); i++)
 	{
-		for (int j(0); j < X_R.ncol(); j++)
+		for (std::size_t j(0); j < endpoint_matrix.columns(); j++)
 		{
-			(*X)(i, j) = X_R(i, j);
+			endpoint_matrix_R(i, j) = endpoint_matrix.operator()(i, j);
 		}
 	}
 
-	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
-	cph::barcode_collection<double> intervals = cph::lw_persistent_homology(metric_space, dimension, max_filtration_value, landmark_set_size,
-			maxmin_sample_size);
+	// NB: we don't have to delete X since metric_space will delete it
+	// delete (X);
+
+	return endpoint_matrix_R;
+}
+
+SEXP cubical_phom(SEXP _values, SEXP _shape, SEXP _dimension, SEXP _max_filtration_value, SEXP _upper_star)
+{
+	// the values are read in place, in the column major order of R arrays
+	Rcpp::NumericVector values_R(_values);
+	Rcpp::IntegerVector shape_R(_shape);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	bool upper_star = Rcpp::as<bool>(_upper_star);
+
+	std::vector<std::size_t> shape(shape_R.size());
+	for (int k(0); k < shape_R.size(); k++)
+	{
+		shape[k] = shape_R[k];
+	}
+
+	cph::barcode_collection<double> intervals = cph::cubical_persistent_homology(values_R.begin(), shape, dimension, max_filtration_value, upper_star);
 	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
 	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
 
@@ -197,33 +358,67 @@ SEXP lw_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value
 		}
 	}
 
-	// NB: we don't have to delete X since metric_space will delete it
-	// delete (X);
-
 	return endpoint_matrix_R;
 }
 
-SEXP lw_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size)
+SEXP lw_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _metric_type, SEXP _power,
+		SEXP _collapse_edges, SEXP _landmark_radius, SEXP _pipelined, SEXP _landmark_seed)
 {
 	Rcpp::NumericMatrix X_R(_matrix);
 
 	int dimension = Rcpp::as<int>(_dimension);
 	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	bool collapse_edges = Rcpp::as<bool>(_collapse_edges);
 	int landmark_set_size = Rcpp::as<int>(_landmark_set_size);
 	int maxmin_sample_size = Rcpp::as<int>(_maxmin_sample_size);
-	cph::basic_matrix<double> * X = new cph::basic_matrix<double>(X_R.nrow(), X_R.ncol());
+	double landmark_radius = Rcpp::as<double>(_landmark_radius);
+	unsigned int landmark_seed = Rcpp::as<unsigned int>(_landmark_seed);
+	bool pipelined = Rcpp::as<bool>(_pipelined);
+	cph::basic_matrix<double> * X = row_major_copy(X_R);
+
+	cph::metric metric_type = (cph::metric) Rcpp::as<int>(_metric_type);
+	double p = Rcpp::as<double>(_power);
 
-	for (int i(0); i < X_R.nrow(); i++)
+	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
+	cph::random_utility::seed(landmark_seed);
+	cph::barcode_collection<double> intervals = cph::lw_persistent_homology(metric_space, dimension, max_filtration_value, landmark_set_size,
+			maxmin_sample_size, collapse_edges, pipelined, landmark_radius);
+	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
+	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
+
+	for (std::size_t i(0); i < endpoint_matrix.rows(); i++)
 	{
-		for (int j(0); j < X_R.ncol(); j++)
+		for (std::size_t j(0); j < endpoint_matrix.columns(); j++)
 		{
-			(*X)(i, j) = X_R(i, j);
+			endpoint_matrix_R(i, j) = endpoint_matrix.operator()(i, j);
 		}
 	}
 
+	// NB: we don't have to delete X since metric_space will delete it
+	// delete (X);
+
+	return endpoint_matrix_R;
+}
+
+SEXP lw_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _collapse_edges,
+		SEXP _landmark_radius, SEXP _pipelined, SEXP _landmark_seed)
+{
+	Rcpp::NumericMatrix X_R(_matrix);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	bool collapse_edges = Rcpp::as<bool>(_collapse_edges);
+	int landmark_set_size = Rcpp::as<int>(_landmark_set_size);
+	int maxmin_sample_size = Rcpp::as<int>(_maxmin_sample_size);
+	double landmark_radius = Rcpp::as<double>(_landmark_radius);
+	unsigned int landmark_seed = Rcpp::as<unsigned int>(_landmark_seed);
+	bool pipelined = Rcpp::as<bool>(_pipelined);
+	cph::basic_matrix<double> * X = matrix_view(X_R);
+
 	cph::explicit_metric_space<double> metric_space(X);
+	cph::random_utility::seed(landmark_seed);
 	cph::barcode_collection<double> intervals = cph::lw_persistent_homology(metric_space, dimension, max_filtration_value, landmark_set_size,
-			maxmin_sample_size);
+			maxmin_sample_size, collapse_edges, pipelined, landmark_radius);
 	cph::basic_matrix<double> endpoint_matrix(intervals.get_endpoint_matrix(max_filtration_value));
 	Rcpp::NumericMatrix endpoint_matrix_R(endpoint_matrix.rows(), endpoint_matrix.columns());
 
@@ -240,3 +435,87 @@ SEXP lw_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, S
 
 	return endpoint_matrix_R;
 }
+
+SEXP vr_euclidean_size(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power, SEXP _collapse_edges, SEXP _samples)
+{
+	Rcpp::NumericMatrix X_R(_matrix);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	bool collapse_edges = Rcpp::as<bool>(_collapse_edges);
+	int samples = Rcpp::as<int>(_samples);
+	cph::basic_matrix<double> * X = row_major_copy(X_R);
+
+	cph::metric metric_type = (cph::metric) Rcpp::as<int>(_metric_type);
+	double p = Rcpp::as<double>(_power);
+
+	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
+	cph::complex_size_estimate estimate = cph::vr_complex_size(metric_space, dimension, max_filtration_value, collapse_edges, samples);
+
+	return size_estimate_to_R(estimate);
+}
+
+SEXP vr_metric_size(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _collapse_edges, SEXP _samples)
+{
+	Rcpp::NumericMatrix X_R(_matrix);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	bool collapse_edges = Rcpp::as<bool>(_collapse_edges);
+	int samples = Rcpp::as<int>(_samples);
+	cph::basic_matrix<double> * X = matrix_view(X_R);
+
+	cph::explicit_metric_space<double> metric_space(X);
+	cph::complex_size_estimate estimate = cph::vr_complex_size(metric_space, dimension, max_filtration_value, collapse_edges, samples);
+
+	return size_estimate_to_R(estimate);
+}
+
+SEXP lw_euclidean_size(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _metric_type, SEXP _power,
+		SEXP _collapse_edges, SEXP _samples, SEXP _landmark_radius, SEXP _landmark_seed)
+{
+	Rcpp::NumericMatrix X_R(_matrix);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	bool collapse_edges = Rcpp::as<bool>(_collapse_edges);
+	int samples = Rcpp::as<int>(_samples);
+	int landmark_set_size = Rcpp::as<int>(_landmark_set_size);
+	int maxmin_sample_size = Rcpp::as<int>(_maxmin_sample_size);
+	double landmark_radius = Rcpp::as<double>(_landmark_radius);
+	unsigned int landmark_seed = Rcpp::as<unsigned int>(_landmark_seed);
+	cph::basic_matrix<double> * X = row_major_copy(X_R);
+
+	cph::metric metric_type = (cph::metric) Rcpp::as<int>(_metric_type);
+	double p = Rcpp::as<double>(_power);
+
+	cph::euclidean_metric_space<double> metric_space(X, metric_type, p);
+	cph::random_utility::seed(landmark_seed);
+	cph::complex_size_estimate estimate = cph::lw_complex_size(metric_space, dimension, max_filtration_value, landmark_set_size, maxmin_sample_size,
+			collapse_edges, samples, landmark_radius);
+
+	return size_estimate_to_R(estimate);
+}
+
+SEXP lw_metric_size(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _collapse_edges,
+		SEXP _samples, SEXP _landmark_radius, SEXP _landmark_seed)
+{
+	Rcpp::NumericMatrix X_R(_matrix);
+
+	int dimension = Rcpp::as<int>(_dimension);
+	double max_filtration_value = Rcpp::as<double>(_max_filtration_value);
+	bool collapse_edges = Rcpp::as<bool>(_collapse_edges);
+	int samples = Rcpp::as<int>(_samples);
+	int landmark_set_size = Rcpp::as<int>(_landmark_set_size);
+	int maxmin_sample_size = Rcpp::as<int>(_maxmin_sample_size);
+	double landmark_radius = Rcpp::as<double>(_landmark_radius);
+	unsigned int landmark_seed = Rcpp::as<unsigned int>(_landmark_seed);
+	cph::basic_matrix<double> * X = matrix_view(X_R);
+
+	cph::explicit_metric_space<double> metric_space(X);
+	cph::random_utility::seed(landmark_seed);
+	cph::complex_size_estimate estimate = cph::lw_complex_size(metric_space, dimension, max_filtration_value, landmark_set_size, maxmin_sample_size,
+			collapse_edges, samples, landmark_radius);
+
+	return size_estimate_to_R(estimate);
+}
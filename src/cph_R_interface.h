@@ -25,10 +25,21 @@
 
 RcppExport SEXP default_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power);
 RcppExport SEXP default_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value);
-RcppExport SEXP vr_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power);
-RcppExport SEXP vr_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value);
-RcppExport SEXP lw_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _metric_type, SEXP _power);
-RcppExport SEXP lw_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size);
+RcppExport SEXP vr_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power, SEXP _collapse_edges, SEXP _spatial_index, SEXP _pipelined);
+RcppExport SEXP vr_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _collapse_edges, SEXP _spatial_index, SEXP _pipelined);
+RcppExport SEXP sparse_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power, SEXP _epsilon);
+RcppExport SEXP sparse_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _epsilon);
+RcppExport SEXP dtm_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power, SEXP _neighbors);
+RcppExport SEXP dtm_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _neighbors);
+RcppExport SEXP alpha_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value);
+RcppExport SEXP cubical_phom(SEXP _values, SEXP _shape, SEXP _dimension, SEXP _max_filtration_value, SEXP _upper_star);
+RcppExport SEXP lw_euclidean_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _metric_type, SEXP _power, SEXP _collapse_edges, SEXP _landmark_radius, SEXP _pipelined, SEXP _landmark_seed);
+RcppExport SEXP lw_metric_phom(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _collapse_edges, SEXP _landmark_radius, SEXP _pipelined, SEXP _landmark_seed);
+
+RcppExport SEXP vr_euclidean_size(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _metric_type, SEXP _power, SEXP _collapse_edges, SEXP _samples);
+RcppExport SEXP vr_metric_size(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _collapse_edges, SEXP _samples);
+RcppExport SEXP lw_euclidean_size(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _metric_type, SEXP _power, SEXP _collapse_edges, SEXP _samples, SEXP _landmark_radius, SEXP _landmark_seed);
+RcppExport SEXP lw_metric_size(SEXP _matrix, SEXP _dimension, SEXP _max_filtration_value, SEXP _landmark_set_size, SEXP _maxmin_sample_size, SEXP _collapse_edges, SEXP _samples, SEXP _landmark_radius, SEXP _landmark_seed);
 
 
 
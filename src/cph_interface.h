@@ -15,27 +15,84 @@
 #include "vietoris_rips_complex.h"
 #include "persistence_algorithm.h"
 #include "lazy_witness_complex.h"
+#include "sparse_rips_complex.h"
+#include "dtm_rips_complex.h"
+#include "alpha_complex.h"
+#include "cubical_complex.h"
+#include "cubical_persistence.h"
 #include "landmark_selector.h"
 #include "basic_matrix.h"
 #include "barcode_collection.h"
+#include "complex_size_estimate.h"
+#include "zero_dimensional_persistence.h"
+#include "pairwise_distances.h"
+#include "parallel_utility.h"
+
+#include <mutex>
+#include <condition_variable>
 
 namespace cph
 {
 	template<class T>
-	T estimate_diameter(const finite_metric_space<T> & metric_space);
+	T diameter(const finite_metric_space<T> & metric_space);
+	template<class T>
+	T enclosing_radius(const finite_metric_space<T> & metric_space);
 	template<class T>
 	barcode_collection<T> default_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value);
 	template<class T>
-	barcode_collection<T> vr_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value);
+	barcode_collection<T> vr_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value,
+			const bool collapse_edges = false, const bool pipelined = false, const bool use_spatial_index = false,
+			T * effective_max_filtration_value = 0);
 	template<class T>
 	barcode_collection<T> lw_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value,
-			const std::size_t landmark_set_size = 50, const std::size_t maxmin_samples = 100);
+			const std::size_t landmark_set_size = 50, const std::size_t maxmin_samples = 100, const bool collapse_edges = false,
+			const bool pipelined = false, const T landmark_radius = 0);
+	template<class T>
+	barcode_collection<T> sparse_rips_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension,
+			const T max_filtration_value, const T epsilon = 0.1);
+	template<class T>
+	barcode_collection<T> dtm_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension,
+			const T max_filtration_value, const std::size_t neighbors = 10);
+	template<class T>
+	barcode_collection<T> alpha_persistent_homology(const euclidean_metric_space<T> & metric_space, const std::size_t dimension,
+			const T max_filtration_value);
+	template<class T>
+	barcode_collection<T> cubical_persistent_homology(const T * values, const std::vector<std::size_t> & shape, const std::size_t dimension,
+			const T max_filtration_value, const bool upper_star = false);
+	template<class T>
+	barcode_collection<T> pipelined_persistent_homology(flag_complex<T> & complex, const std::size_t dimension, const std::size_t batch_size = 16384,
+			const std::size_t queue_capacity = 4);
+	template<class T>
+	complex_size_estimate vr_complex_size(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value,
+			const bool collapse_edges = false, const std::size_t samples = 0, const bool use_spatial_index = false);
+	template<class T>
+	complex_size_estimate lw_complex_size(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value,
+			const std::size_t landmark_set_size = 50, const std::size_t maxmin_samples = 100, const bool collapse_edges = false,
+			const std::size_t samples = 0, const T landmark_radius = 0);
+	template<class T>
+	std::vector<std::size_t> select_landmarks(const finite_metric_space<T> & metric_space, const std::size_t landmark_set_size,
+			const std::size_t maxmin_samples);
+	template<class T>
+	std::vector<std::size_t> select_landmarks(const finite_metric_space<T> & metric_space, const std::size_t landmark_set_size,
+			const std::size_t maxmin_samples, std::vector<T> & landmark_distances, const T landmark_radius = 0);
+
+	/*
+	 * The exact diameter, from all n (n - 1) / 2 distances.
+	 */
+	template<class T>
+	T diameter(const finite_metric_space<T> & metric_space)
+	{
+		return pairwise_distances::diameter(metric_space);
+	}
 
+	/*
+	 * The enclosing radius, the smallest r such that some point is within r of
+	 * all the others. Most points are ruled out after a few distances.
+	 */
 	template<class T>
-	T estimate_diameter(const finite_metric_space<T> & metric_space)
+	T enclosing_radius(const finite_metric_space<T> & metric_space)
 	{
-		T estimated_diameter = metric_space.estimate_diameter();
-		return estimated_diameter;
+		return pairwise_distances::enclosing_radius(metric_space);
 	}
 
 	template<class T>
@@ -62,10 +119,35 @@ namespace cph
 		return cph::lw_persistent_homology(metric_space, dimension, max_filtration_value, landmark_set_size, maxmin_samples);
 	}
 
+	/*
+	 * Past the enclosing radius the Vietoris-Rips complex is a cone, so every
+	 * class other than the essential class in dimension 0 has died by then, and
+	 * larger thresholds only add zero length intervals. The threshold is capped
+	 * there, and the value actually used is written to
+	 * effective_max_filtration_value when it is given.
+	 */
 	template<class T>
-	barcode_collection<T> vr_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value)
+	barcode_collection<T> vr_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value,
+			const bool collapse_edges, const bool pipelined, const bool use_spatial_index, T * effective_max_filtration_value)
 	{
-		vietoris_rips_complex<T> complex(metric_space, max_filtration_value, dimension + 1);
+		const T truncated_max_filtration_value = pairwise_distances::enclosing_radius(metric_space, max_filtration_value);
+		if (effective_max_filtration_value != 0)
+		{
+			*effective_max_filtration_value = truncated_max_filtration_value;
+		}
+
+		vietoris_rips_complex<T> complex(metric_space, truncated_max_filtration_value, dimension + 1, collapse_edges, use_spatial_index);
+
+		if (dimension == 0)
+		{
+			return zero_dimensional_persistence::compute_intervals(complex.get_1_skeleton(), metric_space.size());
+		}
+
+		if (pipelined)
+		{
+			return cph::pipelined_persistent_homology(complex, dimension);
+		}
+
 		complex.construct();
 
 		persistence_algorithm<simplex<typename std::size_t> , T> persistence(dimension);
@@ -76,20 +158,26 @@ namespace cph
 
 	template<class T>
 	barcode_collection<T> lw_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value,
-			const std::size_t landmark_set_size, const std::size_t maxmin_samples)
+			const std::size_t landmark_set_size, const std::size_t maxmin_samples, const bool collapse_edges, const bool pipelined,
+			const T landmark_radius)
 	{
-		std::vector<std::size_t> landmark_selection;
+		std::vector<T> landmark_distances;
+		std::vector<std::size_t> landmark_selection = cph::select_landmarks(metric_space, landmark_set_size, maxmin_samples, landmark_distances,
+				landmark_radius);
 
-		if (metric_space.size() <= maxmin_samples)
+		lazy_witness_complex<T> complex(metric_space, landmark_selection, max_filtration_value, dimension + 1, collapse_edges,
+				landmark_distances.empty() ? 0 : &landmark_distances[0]);
+
+		if (dimension == 0)
 		{
-			landmark_selection = landmark_selector::maxmin_landmark_selection<double>(metric_space, landmark_set_size);
+			return zero_dimensional_persistence::compute_intervals(complex.get_1_skeleton(), landmark_selection.size());
 		}
-		else
+
+		if (pipelined)
 		{
-			landmark_selection = landmark_selector::approx_maxmin_landmark_selection<double>(metric_space, landmark_set_size, maxmin_samples);
+			return cph::pipelined_persistent_homology(complex, dimension);
 		}
 
-		lazy_witness_complex<T> complex(metric_space, landmark_selection, max_filtration_value, dimension + 1);
 		complex.construct();
 
 		persistence_algorithm<simplex<typename std::size_t> , T> persistence(dimension);
@@ -98,5 +186,285 @@ namespace cph
 		return intervals;
 	}
 
+	template<class T>
+	barcode_collection<T> sparse_rips_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension,
+			const T max_filtration_value, const T epsilon)
+	{
+		sparse_rips_complex<T> complex(metric_space, max_filtration_value, dimension + 1, epsilon);
+
+		if (dimension == 0)
+		{
+			return zero_dimensional_persistence::compute_intervals(complex.get_1_skeleton(), metric_space.size());
+		}
+
+		complex.construct();
+
+		persistence_algorithm<simplex<typename std::size_t> , T> persistence(dimension);
+		barcode_collection<T> intervals = persistence.compute_intervals(complex);
+
+		return intervals;
+	}
+
+	/*
+	 * The distance to measure of each point is taken over its given number of
+	 * nearest neighbors, the point itself included, which must be at least 1.
+	 */
+	template<class T>
+	barcode_collection<T> dtm_persistent_homology(const finite_metric_space<T> & metric_space, const std::size_t dimension,
+			const T max_filtration_value, const std::size_t neighbors)
+	{
+		dtm_rips_complex<T> complex(metric_space, max_filtration_value, dimension + 1, neighbors);
+
+		if (dimension == 0)
+		{
+			const std::vector<weighted_edge<T> > edges = complex.get_1_skeleton();
+			return zero_dimensional_persistence::compute_intervals(edges, complex.get_vertex_values(), max_filtration_value);
+		}
+
+		complex.construct();
+
+		persistence_algorithm<simplex<typename std::size_t> , T> persistence(dimension);
+		barcode_collection<T> intervals = persistence.compute_intervals(complex);
+
+		return intervals;
+	}
+
+	/*
+	 * The metric space must use the euclidean metric, on points of dimension 1
+	 * to 3.
+	 */
+	template<class T>
+	barcode_collection<T> alpha_persistent_homology(const euclidean_metric_space<T> & metric_space, const std::size_t dimension,
+			const T max_filtration_value)
+	{
+		alpha_complex<T> complex(metric_space, max_filtration_value, dimension + 1);
+
+		if (dimension == 0)
+		{
+			return zero_dimensional_persistence::compute_intervals(complex.get_1_skeleton(), metric_space.size());
+		}
+
+		complex.construct();
+
+		persistence_algorithm<simplex<typename std::size_t> , T> persistence(dimension);
+		barcode_collection<T> intervals = persistence.compute_intervals(complex);
+
+		return intervals;
+	}
+
+	/*
+	 * The values are those of the vertices of a grid of the given shape, in
+	 * column major order. In the upper star filtration the intervals run down
+	 * from their start to their finish, and max_filtration_value is the
+	 * smallest value reached.
+	 */
+	template<class T>
+	barcode_collection<T> cubical_persistent_homology(const T * values, const std::vector<std::size_t> & shape, const std::size_t dimension,
+			const T max_filtration_value, const bool upper_star)
+	{
+		cubical_complex<T> complex(values, shape, max_filtration_value, upper_star);
+
+		return cubical_persistence::compute_intervals(complex, dimension);
+	}
+
+	/*
+	 * Computes the intervals of the flag complex without storing it as a
+	 * simplex stream: one thread produces the simplices in filtration order,
+	 * one batch at a time, while a second thread reduces them. The threads are
+	 * connected by a queue of at most queue_capacity batches, so the generator
+	 * runs ahead of the reduction by at most that many batches. A thread only
+	 * waits for the other when the queue is full or empty, and then sleeps on a
+	 * condition variable.
+	 *
+	 * A batch holds at most batch_size simplices, even when a single edge has
+	 * more cofaces, so at most queue_capacity * batch_size simplices are held
+	 * between the two threads; the reduction itself keeps the simplices of dimension at most dimension, as described
+	 * in persistence_algorithm. When only one thread is available, the batches
+	 * are produced and reduced in turn.
+	 */
+	template<class T>
+	barcode_collection<T> pipelined_persistent_homology(flag_complex<T> & complex, const std::size_t dimension, const std::size_t batch_size,
+			const std::size_t queue_capacity)
+	{
+		typedef typename flag_filtration_generator<T>::simplex_buffer simplex_buffer;
+
+		flag_filtration_generator<T> * generator = complex.create_filtration_generator();
+
+		persistence_algorithm<simplex<typename std::size_t> , T> persistence(dimension);
+		persistence.begin_stream();
+
+		// batch k is held in slot k % capacity; produced, consumed and finished
+		// are guarded by the mutex, and each thread sleeps on the condition
+		// variable while the queue is full or empty
+		const std::size_t capacity = (queue_capacity > 0 ? queue_capacity : 1);
+		std::vector<simplex_buffer> slots(capacity);
+		std::size_t produced(0), consumed(0);
+		bool finished(false);
+		std::mutex queue_mutex;
+		std::condition_variable queue_changed;
+
+		CPH_OMP(parallel num_threads(2))
+		{
+			if (parallel_utility::thread_count() < 2)
+			{
+				while (generator->next_batch(slots[0], batch_size))
+				{
+					for (std::size_t k = 0; k < slots[0].size(); k++)
+					{
+						persistence.add_simplex(slots[0][k].second, slots[0][k].first);
+					}
+				}
+			}
+			else if (parallel_utility::thread_index() == 0)
+			{
+				bool has_batch(true);
+				while (has_batch)
+				{
+					std::size_t slot(0);
+					{
+						std::unique_lock<std::mutex> lock(queue_mutex);
+						queue_changed.wait(lock, [&] { return produced - consumed < capacity; });
+						slot = produced % capacity;
+					}
+
+					has_batch = generator->next_batch(slots[slot], batch_size);
+
+					{
+						std::lock_guard<std::mutex> lock(queue_mutex);
+						if (has_batch)
+						{
+							produced++;
+						}
+						else
+						{
+							finished = true;
+						}
+					}
+					queue_changed.notify_all();
+				}
+			}
+			else
+			{
+				for (std::size_t next = 0;; next++)
+				{
+					{
+						std::unique_lock<std::mutex> lock(queue_mutex);
+						queue_changed.wait(lock, [&] { return next < produced || finished; });
+						if (next >= produced)
+						{
+							break;
+						}
+					}
+
+					simplex_buffer & batch = slots[next % capacity];
+					for (std::size_t k = 0; k < batch.size(); k++)
+					{
+						persistence.add_simplex(batch[k].second, batch[k].first);
+					}
+					simplex_buffer().swap(batch);
+
+					{
+						std::lock_guard<std::mutex> lock(queue_mutex);
+						consumed = next + 1;
+					}
+					queue_changed.notify_all();
+				}
+			}
+		}
+
+		delete (generator);
+
+		return persistence.end_stream();
+	}
+
+	template<class T>
+	std::vector<std::size_t> select_landmarks(const finite_metric_space<T> & metric_space, const std::size_t landmark_set_size,
+			const std::size_t maxmin_samples)
+	{
+		if (metric_space.size() <= maxmin_samples)
+		{
+			return landmark_selector::maxmin_landmark_selection<T>(metric_space, landmark_set_size);
+		}
+
+		return landmark_selector::approx_maxmin_landmark_selection<T>(metric_space, landmark_set_size, maxmin_samples);
+	}
+
+	/*
+	 * As above, and with the exact maxmin selection the distances from the
+	 * landmarks to all the points are kept in landmark_distances, for
+	 * lazy_witness_complex, as long as these landmark_set_size n distances fit
+	 * in landmark_selector::MAX_KEPT_DISTANCE_BYTES. Otherwise it is left
+	 * empty, and lazy_witness_complex computes the distances block by block
+	 * without holding all of them. A positive
+	 * landmark_radius selects an epsilon-net of that radius instead, and the
+	 * landmark set size is ignored.
+	 */
+	template<class T>
+	std::vector<std::size_t> select_landmarks(const finite_metric_space<T> & metric_space, const std::size_t landmark_set_size,
+			const std::size_t maxmin_samples, std::vector<T> & landmark_distances, const T landmark_radius)
+	{
+		landmark_distances.clear();
+		if (landmark_radius > 0)
+		{
+			return landmark_selector::epsilon_net_landmark_selection<T>(metric_space, landmark_radius);
+		}
+
+		const std::size_t n = metric_space.size();
+		if (n <= maxmin_samples)
+		{
+			if (n > 0 && landmark_set_size <= landmark_selector::MAX_KEPT_DISTANCE_BYTES / (n * sizeof(T)))
+			{
+				return landmark_selector::maxmin_landmark_selection<T>(metric_space, landmark_set_size, landmark_distances);
+			}
+
+			return landmark_selector::maxmin_landmark_selection<T>(metric_space, landmark_set_size);
+		}
+
+		return landmark_selector::approx_maxmin_landmark_selection<T>(metric_space, landmark_set_size, maxmin_samples);
+	}
+
+	/*
+	 * Dry runs of vr_persistent_homology and lw_persistent_homology: the number
+	 * of simplices of the filtration is counted (or estimated from the given number
+	 * of sampled vertices) without storing them, and the memory needed to build and
+	 * reduce the filtration is projected from the counts. As in
+	 * vr_persistent_homology, the Vietoris-Rips threshold is capped at the
+	 * enclosing radius.
+	 */
+	template<class T>
+	complex_size_estimate vr_complex_size(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value,
+			const bool collapse_edges, const std::size_t samples, const bool use_spatial_index)
+	{
+		const T truncated_max_filtration_value = pairwise_distances::enclosing_radius(metric_space, max_filtration_value);
+		vietoris_rips_complex<T> complex(metric_space, truncated_max_filtration_value, dimension + 1, collapse_edges, use_spatial_index);
+
+		complex_size_estimate estimate;
+		estimate.simplices = complex.count_simplices(samples);
+		estimate.construction_memory = flag_complex<T>::projected_construction_memory(estimate.simplices);
+		estimate.reduction_memory = persistence_algorithm<simplex<std::size_t> , T>::projected_memory(estimate.simplices);
+
+		return estimate;
+	}
+
+	template<class T>
+	complex_size_estimate lw_complex_size(const finite_metric_space<T> & metric_space, const std::size_t dimension, const T max_filtration_value,
+			const std::size_t landmark_set_size, const std::size_t maxmin_samples, const bool collapse_edges, const std::size_t samples,
+			const T landmark_radius)
+	{
+		std::vector<T> landmark_distances;
+		std::vector<std::size_t> landmark_selection = cph::select_landmarks(metric_space, landmark_set_size, maxmin_samples, landmark_distances,
+				landmark_radius);
+
+		lazy_witness_complex<T> complex(metric_space, landmark_selection, max_filtration_value, dimension + 1, collapse_edges,
+				landmark_distances.empty() ? 0 : &landmark_distances[0]);
+
+		complex_size_estimate estimate;
+		estimate.simplices = complex.count_simplices(samples);
+		estimate.construction_memory = flag_complex<T>::projected_construction_memory(estimate.simplices);
+		estimate.reduction_memory = persistence_algorithm<simplex<std::size_t> , T>::projected_memory(estimate.simplices);
+
+		return estimate;
+	}
+
 } /* namespace cph */
 #endif /* CPP_INTERFACE_HPP_ */
@@ -0,0 +1,171 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef CSR_GRAPH_H_
+#define CSR_GRAPH_H_
+
+#include <vector>
+#include <algorithm>
+
+#include "weighted_edge.h"
+
+namespace cph
+{
+
+	/*
+	 * Weighted graph in compressed sparse row form, built in bulk from an edge
+	 * list. The lower neighbors of vertex y (the neighbors smaller than y) are
+	 * stored sorted in _neighbors[_offsets[y], _offsets[y + 1]), and the weights
+	 * of the corresponding edges at the same positions of _weights.
+	 *
+	 * Unlike basic_graph, the graph cannot be modified after construction, but a
+	 * weight lookup is a binary search in one contiguous array, and the neighbor
+	 * lists can be used in place.
+	 */
+	template<class W, class V = std::size_t>
+	class csr_graph
+	{
+	public:
+		// element type of the arrays returned by lower_neighbors
+		typedef V neighbor_set_element;
+
+	private:
+		std::size_t _vertex_count;
+		std::vector<std::size_t> _offsets;
+		std::vector<V> _neighbors;
+		std::vector<W> _weights;
+
+	public:
+		csr_graph(const std::vector<weighted_edge<W, V> > & edges, const std::size_t vertex_count) :
+			_vertex_count(vertex_count), _offsets(vertex_count + 1, 0), _neighbors(edges.size()), _weights(edges.size())
+		{
+			// counting sort of the edges by their larger vertex
+			for (typename std::vector<weighted_edge<W, V> >::const_iterator iter = edges.begin(); iter != edges.end(); iter++)
+			{
+				this->_offsets[iter->j + 1]++;
+			}
+
+			for (std::size_t y = 0; y < vertex_count; y++)
+			{
+				this->_offsets[y + 1] += this->_offsets[y];
+			}
+
+			std::vector<std::size_t> next(this->_offsets.begin(), this->_offsets.end() - 1);
+
+			for (typename std::vector<weighted_edge<W, V> >::const_iterator iter = edges.begin(); iter != edges.end(); iter++)
+			{
+				const std::size_t position = next[iter->j]++;
+				this->_neighbors[position] = iter->i;
+				this->_weights[position] = iter->weight;
+			}
+
+			std::vector<std::pair<V, W> > row;
+
+			for (std::size_t y = 0; y < vertex_count; y++)
+			{
+				const std::size_t begin = this->_offsets[y];
+				const std::size_t end = this->_offsets[y + 1];
+
+				row.clear();
+				for (std::size_t k = begin; k < end; k++)
+				{
+					row.push_back(std::make_pair(this->_neighbors[k], this->_weights[k]));
+				}
+				std::sort(row.begin(), row.end());
+
+				for (std::size_t k = begin; k < end; k++)
+				{
+					this->_neighbors[k] = row[k - begin].first;
+					this->_weights[k] = row[k - begin].second;
+				}
+			}
+		}
+
+		virtual ~csr_graph()
+		{
+		}
+
+		std::size_t vertex_count() const
+		{
+			return this->_vertex_count;
+		}
+
+		std::size_t edge_count() const
+		{
+			return this->_neighbors.size();
+		}
+
+		const W get_weight(const V & i, const V & j) const
+		{
+			V x = (i < j ? i : j);
+			V y = (i < j ? j : i);
+
+			const V * begin = this->lower_neighbors(y);
+			const V * end = begin + this->lower_degree(y);
+			const V * position = std::lower_bound(begin, end, x);
+
+			if (position == end || *position != x)
+			{
+				return W(0);
+			}
+			return this->_weights[this->_offsets[y] + (position - begin)];
+		}
+
+		/*
+		 * The sorted array of lower neighbors of y, of length lower_degree(y).
+		 */
+		const V * lower_neighbors(const V & y) const
+		{
+			return (this->_neighbors.empty() ? 0 : &this->_neighbors[0] + this->_offsets[y]);
+		}
+
+		std::size_t lower_degree(const V & y) const
+		{
+			return this->_offsets[y + 1] - this->_offsets[y];
+		}
+
+		std::size_t lower_neighbors_size(const V & y) const
+		{
+			return this->lower_degree(y);
+		}
+
+		std::size_t max_lower_neighbors_size() const
+		{
+			std::size_t result(0);
+			for (std::size_t y = 0; y < this->_vertex_count; y++)
+			{
+				result = std::max(result, this->lower_degree(y));
+			}
+			return result;
+		}
+
+		void lower_neighbor_list(const V & y, std::vector<V> & result) const
+		{
+			result.assign(this->lower_neighbors(y), this->lower_neighbors(y) + this->lower_degree(y));
+		}
+
+		std::vector<weighted_edge<W, V> > edges() const
+		{
+			std::vector<weighted_edge<W, V> > result;
+			result.reserve(this->edge_count());
+
+			for (std::size_t y = 0; y < this->_vertex_count; y++)
+			{
+				for (std::size_t k = this->_offsets[y]; k < this->_offsets[y + 1]; k++)
+				{
+					result.push_back(weighted_edge<W, V> (this->_neighbors[k], y, this->_weights[k]));
+				}
+			}
+
+			return result;
+		}
+	};
+
+}
+
+#endif /* CSR_GRAPH_H_ */
@@ -0,0 +1,242 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef CUBICAL_COMPLEX_H_
+#define CUBICAL_COMPLEX_H_
+
+#include <vector>
+#include <algorithm>
+
+#include "parallel_utility.h"
+
+namespace cph
+{
+
+	/*
+	 * The filtered cubical complex of a function on the vertices of a grid of
+	 * n_0 x ... x n_{d-1} points, such as the pixels of an image (d = 2) or the
+	 * voxels of a volume (d = 3). The values are given in column major order, as
+	 * in an R array, so that the vertex (i_0, ..., i_{d-1}) has the value
+	 * values[i_0 + n_0 (i_1 + n_1 (i_2 + ...))].
+	 *
+	 * In the lower star filtration a cube enters with the largest value of its
+	 * vertices, so that the complex at level t is the union of the cubes on
+	 * which the function is at most t. In the upper star filtration a cube
+	 * enters with the smallest value of its vertices, and the filtration runs
+	 * down from the largest value; it is stored with the values negated, so
+	 * that both filtrations are increasing.
+	 *
+	 * No cubes are stored: a cube is identified with a point of the grid of
+	 * (2 n_0 - 1) x ... x (2 n_{d-1} - 1) cells, whose odd coordinates are the
+	 * directions along which it extends, and its faces are found by moving
+	 * along these directions. The only storage is a bitmap of the filtration
+	 * values of all the cells, indexed by the same column major order.
+	 */
+	template<class T>
+	class cubical_complex
+	{
+	private:
+		std::vector<std::size_t> _shape;
+		std::vector<std::size_t> _strides;
+		std::vector<T> _bitmap;
+		const bool _upper_star;
+		T _max_filtration_value;
+
+	public:
+		cubical_complex(const T * values, const std::vector<std::size_t> & shape, const T max_filtration_value, const bool upper_star = false) :
+			_shape(shape), _strides(shape.size()), _upper_star(upper_star)
+		{
+			const std::size_t d = shape.size();
+			std::size_t cells(1), vertices(1);
+			for (std::size_t k = 0; k < d; k++)
+			{
+				this->_strides[k] = cells;
+				cells *= 2 * shape[k] - 1;
+				vertices *= shape[k];
+			}
+
+			this->_max_filtration_value = (upper_star ? -max_filtration_value : max_filtration_value);
+			this->_bitmap.resize(vertices == 0 ? 0 : cells);
+
+			if (vertices == 0)
+			{
+				return;
+			}
+
+			// the vertices are the cells with even coordinates
+			CPH_OMP(parallel for schedule(static))
+			for (std::size_t v = 0; v < vertices; v++)
+			{
+				std::size_t remainder(v), cell(0);
+				for (std::size_t k = 0; k < d; k++)
+				{
+					cell += 2 * (remainder % shape[k]) * this->_strides[k];
+					remainder /= shape[k];
+				}
+				this->_bitmap[cell] = (upper_star ? -values[v] : values[v]);
+			}
+
+			// after the k-th pass, every cell extending only along the directions
+			// 0, ..., k has the largest value of its two facets along direction k,
+			// which have been set by the previous passes
+			for (std::size_t k = 0; k < d; k++)
+			{
+				CPH_OMP(parallel for schedule(static))
+				for (std::size_t cell = 0; cell < cells; cell++)
+				{
+					if (this->extends_along(cell, k) && this->last_direction(cell) == k)
+					{
+						this->_bitmap[cell] = std::max(this->_bitmap[cell - this->_strides[k]], this->_bitmap[cell + this->_strides[k]]);
+					}
+				}
+			}
+		}
+
+		virtual ~cubical_complex()
+		{
+		}
+
+		std::size_t size() const
+		{
+			return this->_bitmap.size();
+		}
+
+		/*
+		 * The dimension of the grid.
+		 */
+		std::size_t grid_dimension() const
+		{
+			return this->_shape.size();
+		}
+
+		/*
+		 * The number of directions along which the cell extends.
+		 */
+		std::size_t dimension(const std::size_t cell) const
+		{
+			std::size_t result(0);
+			for (std::size_t k = 0; k < this->_shape.size(); k++)
+			{
+				if (this->extends_along(cell, k))
+				{
+					result++;
+				}
+			}
+			return result;
+		}
+
+		/*
+		 * Appends the cells of the given dimension which enter at or before the
+		 * maximum filtration value to result, in increasing order. The coordinates
+		 * are kept in a counter, so no cell index is decomposed.
+		 */
+		void append_cells(const std::size_t dimension, std::vector<std::size_t> & result) const
+		{
+			const std::size_t d = this->_shape.size();
+			if (this->_bitmap.empty())
+			{
+				return;
+			}
+
+			std::vector<std::size_t> coordinates(d, 0);
+			std::size_t odd_coordinates(0);
+
+			for (std::size_t cell = 0; cell < this->_bitmap.size(); cell++)
+			{
+				if (odd_coordinates == dimension && this->contains(cell))
+				{
+					result.push_back(cell);
+				}
+
+				for (std::size_t k = 0; k < d; k++)
+				{
+					coordinates[k]++;
+					if (coordinates[k] < 2 * this->_shape[k] - 1)
+					{
+						if (coordinates[k] % 2 == 1)
+						{
+							odd_coordinates++;
+						}
+						else
+						{
+							odd_coordinates--;
+						}
+						break;
+					}
+					// the coordinate wraps around from 2 n_k - 2, which is even, to 0
+					coordinates[k] = 0;
+				}
+			}
+		}
+
+		/*
+		 * The filtration value of the cell, negated in the upper star filtration.
+		 */
+		T filtration_value(const std::size_t cell) const
+		{
+			return this->_bitmap[cell];
+		}
+
+		/*
+		 * Whether the cell enters at or before the maximum filtration value.
+		 */
+		bool contains(const std::size_t cell) const
+		{
+			return (this->_bitmap[cell] <= this->_max_filtration_value);
+		}
+
+		/*
+		 * Maps a filtration value back to the scale of the input values.
+		 */
+		T input_value(const T filtration_value) const
+		{
+			return (this->_upper_star ? -filtration_value : filtration_value);
+		}
+
+		/*
+		 * Appends the facets of the cell to result: for each direction along which
+		 * the cell extends, the two cells on either side of it.
+		 */
+		void boundary(const std::size_t cell, std::vector<std::size_t> & result) const
+		{
+			for (std::size_t k = 0; k < this->_shape.size(); k++)
+			{
+				if (this->extends_along(cell, k))
+				{
+					result.push_back(cell - this->_strides[k]);
+					result.push_back(cell + this->_strides[k]);
+				}
+			}
+		}
+
+	private:
+		bool extends_along(const std::size_t cell, const std::size_t k) const
+		{
+			return ((cell / this->_strides[k]) % (2 * this->_shape[k] - 1)) % 2 == 1;
+		}
+
+		/*
+		 * The last direction along which the cell extends, or grid_dimension() for
+		 * a vertex.
+		 */
+		std::size_t last_direction(const std::size_t cell) const
+		{
+			for (std::size_t k = this->_shape.size(); k > 0; k--)
+			{
+				if (this->extends_along(cell, k - 1))
+				{
+					return k - 1;
+				}
+			}
+			return this->_shape.size();
+		}
+	};
+
+}
+
+#endif /* CUBICAL_COMPLEX_H_ */
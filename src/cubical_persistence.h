@@ -0,0 +1,286 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef CUBICAL_PERSISTENCE_H_
+#define CUBICAL_PERSISTENCE_H_
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+
+#include "cubical_complex.h"
+#include "union_find.h"
+#include "barcode_collection.h"
+
+namespace cph
+{
+
+	/*
+	 * Computes the persistence intervals of a cubical_complex directly from its
+	 * bitmap, without building a simplex stream.
+	 *
+	 * The cells are ordered by filtration value, then by dimension, and then by
+	 * index. The 0-dimensional intervals are found with a union-find pass over
+	 * the edges, with the elder rule. The higher intervals are found by reducing
+	 * the boundary matrices from the top dimension down, with clearing: a cell
+	 * which is the pivot of a reduced column of the dimension above is paired,
+	 * so its own column is skipped. The working column is a heap of cells in
+	 * which pairs of equal entries cancel, and only the columns which are added
+	 * to later columns are kept.
+	 *
+	 * Intervals of length zero are not reported, as in persistence_algorithm.
+	 */
+	class cubical_persistence
+	{
+	private:
+		static const std::size_t NONE = static_cast<std::size_t> (-1);
+
+		cubical_persistence()
+		{
+		}
+
+		template<class T>
+		struct cell_entry
+		{
+			T value;
+			std::size_t index;
+
+			cell_entry()
+			{
+			}
+
+			cell_entry(const T value, const std::size_t index) :
+				value(value), index(index)
+			{
+			}
+
+			bool operator <(const cell_entry<T> & other) const
+			{
+				if (this->value != other.value)
+				{
+					return (this->value < other.value);
+				}
+				return (this->index < other.index);
+			}
+
+			bool operator ==(const cell_entry<T> & other) const
+			{
+				return (this->index == other.index);
+			}
+		};
+
+	public:
+		virtual ~cubical_persistence()
+		{
+		}
+
+		template<class T>
+		static barcode_collection<T> compute_intervals(const cubical_complex<T> & complex, const std::size_t max_dimension)
+		{
+			barcode_collection<T> intervals;
+			std::vector<bool> paired(complex.size(), false);
+
+			const std::size_t top_dimension = std::min(max_dimension + 1, complex.grid_dimension());
+			for (std::size_t q = top_dimension; q >= 2; q--)
+			{
+				cubical_persistence::reduce(complex, q, max_dimension, paired, intervals);
+			}
+
+			cubical_persistence::compute_low_dimensional_intervals(complex, max_dimension, paired, intervals);
+
+			return intervals;
+		}
+
+	private:
+		/*
+		 * Reduces the columns of the cells of dimension q, which pair cells of
+		 * dimension q - 1 with cells of dimension q.
+		 */
+		template<class T>
+		static void reduce(const cubical_complex<T> & complex, const std::size_t q, const std::size_t max_dimension, std::vector<bool> & paired,
+				barcode_collection<T> & intervals)
+		{
+			std::vector<cell_entry<T> > columns = cubical_persistence::sorted_cells(complex, q, paired);
+
+			// the reduced columns, stored one after the other, and the start of the
+			// column with a given pivot, the column ending where the next one starts
+			std::vector<cell_entry<T> > reduced_entries;
+			std::vector<std::size_t> column_starts;
+			std::vector<std::size_t> pivot_columns(complex.size(), std::size_t(NONE));
+
+			std::priority_queue<cell_entry<T> > working_column;
+			std::vector<std::size_t> facets;
+
+			for (typename std::vector<cell_entry<T> >::const_iterator column = columns.begin(); column != columns.end(); column++)
+			{
+				facets.clear();
+				complex.boundary(column->index, facets);
+				for (std::vector<std::size_t>::const_iterator iter = facets.begin(); iter != facets.end(); iter++)
+				{
+					working_column.push(cell_entry<T> (complex.filtration_value(*iter), *iter));
+				}
+
+				cell_entry<T> pivot;
+				bool has_pivot = cubical_persistence::pop_pivot(working_column, pivot);
+				while (has_pivot)
+				{
+					const std::size_t other = pivot_columns[pivot.index];
+					if (other == NONE)
+					{
+						break;
+					}
+
+					// the pivots cancel, so only the rest of the other column is added
+					for (std::size_t k = column_starts[other] + 1; k < column_starts[other + 1]; k++)
+					{
+						working_column.push(reduced_entries[k]);
+					}
+					has_pivot = cubical_persistence::pop_pivot(working_column, pivot);
+				}
+
+				if (!has_pivot)
+				{
+					if (q <= max_dimension)
+					{
+						intervals.add_interval(q, complex.input_value(column->value));
+					}
+					continue;
+				}
+
+				paired[pivot.index] = true;
+				if (pivot.value < column->value)
+				{
+					intervals.add_interval(q - 1, complex.input_value(pivot.value), complex.input_value(column->value));
+				}
+
+				// the reduced column is stored with its pivot first
+				if (column_starts.empty())
+				{
+					column_starts.push_back(0);
+				}
+				pivot_columns[pivot.index] = column_starts.size() - 1;
+				reduced_entries.push_back(pivot);
+				cell_entry<T> entry;
+				while (cubical_persistence::pop_pivot(working_column, entry))
+				{
+					reduced_entries.push_back(entry);
+				}
+				column_starts.push_back(reduced_entries.size());
+			}
+		}
+
+		/*
+		 * The 0-dimensional intervals, and the infinite 1-dimensional intervals
+		 * of the edges which do not join two components and are not paired.
+		 */
+		template<class T>
+		static void compute_low_dimensional_intervals(const cubical_complex<T> & complex, const std::size_t max_dimension,
+				const std::vector<bool> & paired, barcode_collection<T> & intervals)
+		{
+			const std::vector<cell_entry<T> > edges = cubical_persistence::sorted_cells(complex, 1, std::vector<bool>(complex.size(), false));
+
+			union_find components(complex.size());
+
+			// the oldest vertex of the component of each root
+			std::vector<std::size_t> oldest(complex.size());
+			for (std::size_t cell = 0; cell < complex.size(); cell++)
+			{
+				oldest[cell] = cell;
+			}
+
+			std::vector<std::size_t> facets;
+			for (typename std::vector<cell_entry<T> >::const_iterator edge = edges.begin(); edge != edges.end(); edge++)
+			{
+				facets.clear();
+				complex.boundary(edge->index, facets);
+
+				const std::size_t a = oldest[components.find(facets[0])];
+				const std::size_t b = oldest[components.find(facets[1])];
+
+				if (!components.join(facets[0], facets[1]))
+				{
+					if (max_dimension >= 1 && !paired[edge->index])
+					{
+						intervals.add_interval(1, complex.input_value(edge->value));
+					}
+					continue;
+				}
+
+				const cell_entry<T> first(complex.filtration_value(a), a);
+				const cell_entry<T> second(complex.filtration_value(b), b);
+				const cell_entry<T> & elder = (first < second ? first : second);
+				const cell_entry<T> & younger = (first < second ? second : first);
+
+				oldest[components.find(a)] = elder.index;
+				if (younger.value < edge->value)
+				{
+					intervals.add_interval(0, complex.input_value(younger.value), complex.input_value(edge->value));
+				}
+			}
+
+			std::vector<std::size_t> vertices;
+			complex.append_cells(0, vertices);
+			for (std::vector<std::size_t>::const_iterator vertex = vertices.begin(); vertex != vertices.end(); vertex++)
+			{
+				if (components.find(*vertex) == *vertex)
+				{
+					intervals.add_interval(0, complex.input_value(complex.filtration_value(oldest[*vertex])));
+				}
+			}
+		}
+
+		/*
+		 * The cells of dimension q in the filtration which are not paired, in
+		 * filtration order.
+		 */
+		template<class T>
+		static std::vector<cell_entry<T> > sorted_cells(const cubical_complex<T> & complex, const std::size_t q, const std::vector<bool> & paired)
+		{
+			std::vector<std::size_t> cells;
+			complex.append_cells(q, cells);
+
+			std::vector<cell_entry<T> > result;
+			result.reserve(cells.size());
+			for (std::vector<std::size_t>::const_iterator iter = cells.begin(); iter != cells.end(); iter++)
+			{
+				if (!paired[*iter])
+				{
+					result.push_back(cell_entry<T> (complex.filtration_value(*iter), *iter));
+				}
+			}
+			std::sort(result.begin(), result.end());
+
+			return result;
+		}
+
+		/*
+		 * Removes the largest entry of the column which does not cancel with
+		 * another copy of itself, and returns false if there is none.
+		 */
+		template<class T>
+		static bool pop_pivot(std::priority_queue<cell_entry<T> > & column, cell_entry<T> & pivot)
+		{
+			while (!column.empty())
+			{
+				pivot = column.top();
+				column.pop();
+
+				if (column.empty() || !(column.top() == pivot))
+				{
+					return true;
+				}
+				column.pop();
+			}
+
+			return false;
+		}
+	};
+
+}
+
+#endif /* CUBICAL_PERSISTENCE_H_ */
@@ -0,0 +1,765 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef DELAUNAY_TRIANGULATION_H_
+#define DELAUNAY_TRIANGULATION_H_
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+#include "basic_matrix.h"
+
+namespace cph
+{
+
+	/*
+	 * Delaunay triangulation of points in dimension 1 to MAX_DIMENSION, built by
+	 * Bowyer-Watson insertion: each new point removes the cells whose
+	 * circumsphere contains it, and the cavity is filled with the cells joining
+	 * the point to the boundary of the cavity.
+	 *
+	 * The convex hull is closed off by ghost cells, which join a hull facet to a
+	 * vertex at infinity; a point beyond a hull facet is in conflict with its
+	 * ghost cell. All cells are kept positively oriented, and for a ghost cell
+	 * this means that replacing the vertex at infinity by a point beyond its
+	 * facet gives a positive orientation.
+	 *
+	 * The points are inserted in Morton order, and the cell containing each new
+	 * point is found by walking from the last cell created, so that the walks
+	 * are short. The predicates are evaluated in long double. Rather than
+	 * handling degenerate configurations (cospherical or coplanar points, as on
+	 * grids) symbolically, the coordinates are moved by a deterministic relative
+	 * perturbation of PERTURBATION times the extent of the point set, and the
+	 * triangulation is that of the perturbed points, which are available through
+	 * point().
+	 */
+	template<class T>
+	class delaunay_triangulation
+	{
+	public:
+		static const std::size_t MAX_DIMENSION = 3;
+
+	private:
+		static const double PERTURBATION;
+
+		struct facet_key
+		{
+			std::size_t vertices[MAX_DIMENSION];
+			std::size_t cell;
+			std::size_t index;
+
+			bool operator <(const facet_key & other) const
+			{
+				return std::lexicographical_compare(this->vertices, this->vertices + MAX_DIMENSION, other.vertices, other.vertices + MAX_DIMENSION);
+			}
+
+			bool same_facet(const facet_key & other) const
+			{
+				return std::equal(this->vertices, this->vertices + MAX_DIMENSION, other.vertices);
+			}
+		};
+
+		const std::size_t _dimension;
+		const std::size_t _point_count;
+		const std::size_t _infinite_vertex;
+		const std::size_t _no_cell;
+
+		std::vector<T> _coordinates;
+
+		// D + 1 vertices per cell, and the neighbor opposite each of them
+		std::vector<std::size_t> _cell_vertices;
+		std::vector<std::size_t> _cell_neighbors;
+		std::vector<bool> _alive;
+		std::vector<std::size_t> _free_cells;
+
+		// conflict marks of the cavity search, valid when the stamp is current
+		std::vector<std::size_t> _stamps;
+		std::vector<bool> _in_conflict;
+		std::size_t _stamp;
+
+		// scratch space of insert, kept to avoid reallocating it for every point
+		std::vector<std::size_t> _stack, _cavity, _created;
+		std::vector<std::pair<std::size_t, std::size_t> > _boundary;
+		std::vector<facet_key> _keys;
+
+		std::size_t _last_cell;
+		unsigned long long _random_state;
+		long double _insphere_sign;
+
+	public:
+		delaunay_triangulation(const basic_matrix<T> & points) :
+			_dimension(points.columns()), _point_count(points.rows()), _infinite_vertex(points.rows()), _no_cell(std::size_t(-1)),
+					_coordinates(points.rows() * points.columns()), _stamp(0), _last_cell(0), _random_state(0x9e3779b97f4a7c15ULL),
+					_insphere_sign(1)
+		{
+			this->perturb(points);
+			this->calibrate();
+
+			if (this->_point_count > this->_dimension)
+			{
+				this->triangulate();
+			}
+		}
+
+		virtual ~delaunay_triangulation()
+		{
+		}
+
+		std::size_t dimension() const
+		{
+			return this->_dimension;
+		}
+
+		/*
+		 * The perturbed coordinates of point i.
+		 */
+		const T * point(const std::size_t i) const
+		{
+			return &this->_coordinates[i * this->_dimension];
+		}
+
+		/*
+		 * The maximal simplices of the triangulation, each as
+		 * simplex_dimension + 1 sorted vertices, one after the other. With no
+		 * more than D points, this is the single simplex spanned by all of them.
+		 */
+		std::vector<std::size_t> maximal_simplices(std::size_t & simplex_dimension) const
+		{
+			std::vector<std::size_t> result;
+
+			if (this->_point_count <= this->_dimension)
+			{
+				simplex_dimension = this->_point_count - (this->_point_count > 0);
+				for (std::size_t i = 0; i < this->_point_count; i++)
+				{
+					result.push_back(i);
+				}
+				return result;
+			}
+
+			const std::size_t width = this->_dimension + 1;
+			simplex_dimension = this->_dimension;
+
+			for (std::size_t c = 0; c < this->_alive.size(); c++)
+			{
+				if (this->_alive[c] && !this->is_ghost(c))
+				{
+					const std::size_t begin = result.size();
+					result.insert(result.end(), this->_cell_vertices.begin() + c * width, this->_cell_vertices.begin() + (c + 1) * width);
+					std::sort(result.begin() + begin, result.end());
+				}
+			}
+
+			return result;
+		}
+
+	private:
+		void perturb(const basic_matrix<T> & points)
+		{
+			T extent(0);
+			for (std::size_t d = 0; d < this->_dimension; d++)
+			{
+				T min(0), max(0);
+				for (std::size_t i = 0; i < this->_point_count; i++)
+				{
+					min = (i == 0 || points(i, d) < min ? points(i, d) : min);
+					max = (i == 0 || points(i, d) > max ? points(i, d) : max);
+				}
+				extent = std::max(extent, max - min);
+			}
+			if (extent <= 0)
+			{
+				extent = T(1);
+			}
+
+			for (std::size_t i = 0; i < this->_point_count; i++)
+			{
+				for (std::size_t d = 0; d < this->_dimension; d++)
+				{
+					const double offset = 2 * delaunay_triangulation::uniform_hash(i * this->_dimension + d) - 1;
+					this->_coordinates[i * this->_dimension + d] = points(i, d) + T(PERTURBATION * offset * extent);
+				}
+			}
+		}
+
+		/*
+		 * The sign of the insphere determinant depends on the dimension; it is
+		 * fixed here on the unit simplex, which is positively oriented, and a point
+		 * inside its circumsphere.
+		 */
+		void calibrate()
+		{
+			const std::size_t D = this->_dimension;
+			std::vector<long double> simplex_coordinates((D + 1) * D, 0), inside(D, 0.1L);
+			const long double * vertices[MAX_DIMENSION + 1];
+
+			for (std::size_t i = 0; i <= D; i++)
+			{
+				if (i > 0)
+				{
+					simplex_coordinates[i * D + i - 1] = 1;
+				}
+				vertices[i] = &simplex_coordinates[i * D];
+			}
+
+			this->_insphere_sign = (this->insphere(vertices, &inside[0]) > 0 ? 1 : -1);
+		}
+
+		void triangulate()
+		{
+			std::vector<std::size_t> order = this->morton_order();
+			std::vector<std::size_t> initial = this->initial_simplex(order);
+
+			std::vector<bool> inserted(this->_point_count, false);
+			for (std::size_t i = 0; i < initial.size(); i++)
+			{
+				inserted[initial[i]] = true;
+			}
+
+			this->create_initial_cells(initial);
+
+			for (std::vector<std::size_t>::const_iterator iter = order.begin(); iter != order.end(); iter++)
+			{
+				if (!inserted[*iter])
+				{
+					this->insert(*iter);
+				}
+			}
+		}
+
+		std::vector<std::size_t> morton_order() const
+		{
+			const std::size_t D = this->_dimension;
+			const std::size_t bits = 63 / D < 21 ? 63 / D : 21;
+			const double scale = double((1ULL << bits) - 1);
+
+			std::vector<T> min(this->point(0), this->point(0) + D), max(min);
+			for (std::size_t i = 0; i < this->_point_count; i++)
+			{
+				for (std::size_t d = 0; d < D; d++)
+				{
+					min[d] = std::min(min[d], this->point(i)[d]);
+					max[d] = std::max(max[d], this->point(i)[d]);
+				}
+			}
+
+			std::vector<std::pair<unsigned long long, std::size_t> > codes(this->_point_count);
+			for (std::size_t i = 0; i < this->_point_count; i++)
+			{
+				unsigned long long code(0);
+				for (std::size_t d = 0; d < D; d++)
+				{
+					const double extent = double(max[d] - min[d]);
+					const unsigned long long q = (unsigned long long) (extent > 0 ? scale * double(this->point(i)[d] - min[d]) / extent : 0);
+					for (std::size_t b = 0; b < bits; b++)
+					{
+						code |= ((q >> b) & 1ULL) << (b * D + d);
+					}
+				}
+				codes[i] = std::make_pair(code, i);
+			}
+			std::sort(codes.begin(), codes.end());
+
+			std::vector<std::size_t> order(this->_point_count);
+			for (std::size_t i = 0; i < this->_point_count; i++)
+			{
+				order[i] = codes[i].second;
+			}
+			return order;
+		}
+
+		/*
+		 * Starting from the first point of the order, repeatedly adds the point
+		 * furthest from the affine hull of the points chosen so far, so that the
+		 * first cell is as far from degenerate as the data allows.
+		 */
+		std::vector<std::size_t> initial_simplex(const std::vector<std::size_t> & order) const
+		{
+			const std::size_t D = this->_dimension;
+			std::vector<std::size_t> chosen(1, order[0]);
+			std::vector<std::vector<long double> > basis;
+			const T * origin = this->point(order[0]);
+
+			while (chosen.size() <= D)
+			{
+				long double max_distance(-1);
+				std::size_t arg_max(0);
+				std::vector<long double> residual(D), max_residual(D);
+
+				for (std::size_t i = 0; i < this->_point_count; i++)
+				{
+					for (std::size_t d = 0; d < D; d++)
+					{
+						residual[d] = (long double) this->point(i)[d] - origin[d];
+					}
+					for (std::size_t b = 0; b < basis.size(); b++)
+					{
+						long double projection(0);
+						for (std::size_t d = 0; d < D; d++)
+						{
+							projection += residual[d] * basis[b][d];
+						}
+						for (std::size_t d = 0; d < D; d++)
+						{
+							residual[d] -= projection * basis[b][d];
+						}
+					}
+
+					long double distance(0);
+					for (std::size_t d = 0; d < D; d++)
+					{
+						distance += residual[d] * residual[d];
+					}
+
+					if (distance > max_distance && std::find(chosen.begin(), chosen.end(), i) == chosen.end())
+					{
+						max_distance = distance;
+						arg_max = i;
+						max_residual = residual;
+					}
+				}
+
+				const long double norm = std::sqrt(max_distance);
+				for (std::size_t d = 0; d < D; d++)
+				{
+					max_residual[d] = (norm > 0 ? max_residual[d] / norm : 0);
+				}
+
+				chosen.push_back(arg_max);
+				basis.push_back(max_residual);
+			}
+
+			return chosen;
+		}
+
+		void create_initial_cells(std::vector<std::size_t> initial)
+		{
+			const std::size_t D = this->_dimension;
+
+			if (this->orientation(&initial[0], D + 1, 0) < 0)
+			{
+				std::swap(initial[0], initial[1]);
+			}
+
+			std::vector<std::size_t> cells(1, this->new_cell(&initial[0]));
+
+			// the ghost cell on the facet opposite vertex k, with two vertices swapped
+			// so that it is positively oriented
+			for (std::size_t k = 0; k <= D; k++)
+			{
+				std::vector<std::size_t> ghost(initial);
+				ghost[k] = this->_infinite_vertex;
+				std::swap(ghost[k], ghost[(k + 1) % (D + 1)]);
+				cells.push_back(this->new_cell(&ghost[0]));
+			}
+
+			this->link_cells(cells);
+			this->_last_cell = cells[0];
+		}
+
+		void insert(const std::size_t p)
+		{
+			const std::size_t D = this->_dimension;
+			const std::size_t width = D + 1;
+
+			const std::size_t start = this->locate(p);
+			if (start == this->_no_cell)
+			{
+				// the point coincides with a vertex
+				return;
+			}
+
+			this->_stamp++;
+			this->mark(start, true);
+
+			std::vector<std::size_t> & stack = this->_stack;
+			std::vector<std::size_t> & cavity = this->_cavity;
+			std::vector<std::size_t> & created = this->_created;
+			std::vector<std::pair<std::size_t, std::size_t> > & boundary = this->_boundary;
+			stack.assign(1, start);
+			cavity.clear();
+			created.clear();
+			boundary.clear();
+
+			while (!stack.empty())
+			{
+				const std::size_t c = stack.back();
+				stack.pop_back();
+				cavity.push_back(c);
+
+				for (std::size_t k = 0; k < width; k++)
+				{
+					const std::size_t neighbor = this->_cell_neighbors[c * width + k];
+					if (this->_stamps[neighbor] != this->_stamp)
+					{
+						const bool conflict = this->in_conflict(neighbor, p);
+						this->mark(neighbor, conflict);
+						if (conflict)
+						{
+							stack.push_back(neighbor);
+							continue;
+						}
+					}
+
+					if (!this->_in_conflict[neighbor])
+					{
+						boundary.push_back(std::make_pair(c, k));
+					}
+				}
+			}
+
+			// one new cell per boundary facet, joining it to p
+			std::size_t vertices[MAX_DIMENSION + 1];
+			for (std::vector<std::pair<std::size_t, std::size_t> >::const_iterator iter = boundary.begin(); iter != boundary.end(); iter++)
+			{
+				const std::size_t c = iter->first;
+				const std::size_t k = iter->second;
+				const std::size_t neighbor = this->_cell_neighbors[c * width + k];
+
+				std::copy(this->_cell_vertices.begin() + c * width, this->_cell_vertices.begin() + (c + 1) * width, vertices);
+				vertices[k] = p;
+
+				const std::size_t cell = this->new_cell(vertices);
+				this->_cell_neighbors[cell * width + k] = neighbor;
+				for (std::size_t j = 0; j < width; j++)
+				{
+					if (this->_cell_neighbors[neighbor * width + j] == c)
+					{
+						this->_cell_neighbors[neighbor * width + j] = cell;
+					}
+				}
+				created.push_back(cell);
+			}
+
+			this->link_cells(created);
+
+			for (std::vector<std::size_t>::const_iterator iter = cavity.begin(); iter != cavity.end(); iter++)
+			{
+				this->_alive[*iter] = false;
+				this->_free_cells.push_back(*iter);
+			}
+
+			this->_last_cell = created.front();
+			for (std::vector<std::size_t>::const_iterator iter = created.begin(); iter != created.end(); iter++)
+			{
+				if (!this->is_ghost(*iter))
+				{
+					this->_last_cell = *iter;
+					break;
+				}
+			}
+		}
+
+		/*
+		 * Walks towards p, crossing at each step a facet which separates the
+		 * current cell from p (chosen at random, so that the walk cannot cycle),
+		 * and returns a cell in conflict with p.
+		 */
+		std::size_t locate(const std::size_t p)
+		{
+			const std::size_t width = this->_dimension + 1;
+			std::size_t c = this->_last_cell;
+
+			if (this->is_ghost(c))
+			{
+				const std::size_t * vertices = &this->_cell_vertices[c * width];
+				c = this->_cell_neighbors[c * width + (std::find(vertices, vertices + width, this->_infinite_vertex) - vertices)];
+			}
+
+			for (std::size_t steps = 0; steps < this->_alive.size(); steps++)
+			{
+				if (this->is_ghost(c))
+				{
+					if (this->in_conflict(c, p))
+					{
+						return c;
+					}
+					break;
+				}
+
+				bool moved(false);
+				const std::size_t first = std::size_t(this->next_random() % width);
+				for (std::size_t t = 0; t < width && !moved; t++)
+				{
+					const std::size_t k = (first + t) % width;
+					if (this->orientation(&this->_cell_vertices[c * width], k, p) < 0)
+					{
+						c = this->_cell_neighbors[c * width + k];
+						moved = true;
+					}
+				}
+
+				if (!moved)
+				{
+					return (this->in_conflict(c, p) ? c : this->_no_cell);
+				}
+			}
+
+			// only reached through rounding problems
+			for (std::size_t cell = 0; cell < this->_alive.size(); cell++)
+			{
+				if (this->_alive[cell] && this->in_conflict(cell, p))
+				{
+					return cell;
+				}
+			}
+
+			return this->_no_cell;
+		}
+
+		bool in_conflict(const std::size_t c, const std::size_t p) const
+		{
+			const std::size_t D = this->_dimension;
+			const std::size_t * vertices = &this->_cell_vertices[c * (D + 1)];
+
+			const std::size_t j = std::find(vertices, vertices + D + 1, this->_infinite_vertex) - vertices;
+			if (j <= D)
+			{
+				const long double side = this->orientation(vertices, j, p);
+				if (side != 0)
+				{
+					return (side > 0);
+				}
+
+				// p lies on the hull facet: it conflicts if it is inside the
+				// circumsphere of the finite cell on the facet
+				return this->in_conflict(this->_cell_neighbors[c * (D + 1) + j], p);
+			}
+
+			const long double * coordinates[MAX_DIMENSION + 1];
+			long double storage[(MAX_DIMENSION + 2) * MAX_DIMENSION];
+			for (std::size_t i = 0; i <= D; i++)
+			{
+				this->load(vertices[i], &storage[i * D]);
+				coordinates[i] = &storage[i * D];
+			}
+			this->load(p, &storage[(D + 1) * D]);
+
+			return (this->_insphere_sign * this->insphere(coordinates, &storage[(D + 1) * D]) > 0);
+		}
+
+		/*
+		 * The orientation of the cell with the given vertices, with vertex k
+		 * replaced by p (no vertex is replaced if k > D).
+		 */
+		long double orientation(const std::size_t * vertices, const std::size_t k, const std::size_t p) const
+		{
+			const std::size_t D = this->_dimension;
+			long double matrix[MAX_DIMENSION * MAX_DIMENSION];
+			long double origin[MAX_DIMENSION], row[MAX_DIMENSION];
+
+			this->load(k == 0 ? p : vertices[0], origin);
+			for (std::size_t i = 1; i <= D; i++)
+			{
+				this->load(k == i ? p : vertices[i], row);
+				for (std::size_t d = 0; d < D; d++)
+				{
+					matrix[(i - 1) * D + d] = row[d] - origin[d];
+				}
+			}
+
+			return delaunay_triangulation::determinant(matrix, D);
+		}
+
+		long double insphere(const long double * const * vertices, const long double * q) const
+		{
+			const std::size_t D = this->_dimension;
+			long double matrix[(MAX_DIMENSION + 1) * (MAX_DIMENSION + 1)];
+
+			for (std::size_t i = 0; i <= D; i++)
+			{
+				long double lift(0);
+				for (std::size_t d = 0; d < D; d++)
+				{
+					const long double difference = vertices[i][d] - q[d];
+					matrix[i * (D + 1) + d] = difference;
+					lift += difference * difference;
+				}
+				matrix[i * (D + 1) + D] = lift;
+			}
+
+			return delaunay_triangulation::determinant(matrix, D + 1);
+		}
+
+		inline void load(const std::size_t vertex, long double * result) const
+		{
+			for (std::size_t d = 0; d < this->_dimension; d++)
+			{
+				result[d] = this->_coordinates[vertex * this->_dimension + d];
+			}
+		}
+
+		/*
+		 * Determinant of the size x size row major matrix, by Gaussian elimination
+		 * with partial pivoting. The matrix is overwritten.
+		 */
+		static long double determinant(long double * matrix, const std::size_t size)
+		{
+			long double result(1);
+
+			for (std::size_t column = 0; column < size; column++)
+			{
+				std::size_t pivot = column;
+				for (std::size_t row = column + 1; row < size; row++)
+				{
+					if (std::fabs(matrix[row * size + column]) > std::fabs(matrix[pivot * size + column]))
+					{
+						pivot = row;
+					}
+				}
+
+				if (matrix[pivot * size + column] == 0)
+				{
+					return 0;
+				}
+
+				if (pivot != column)
+				{
+					std::swap_ranges(matrix + pivot * size, matrix + (pivot + 1) * size, matrix + column * size);
+					result = -result;
+				}
+
+				result *= matrix[column * size + column];
+
+				for (std::size_t row = column + 1; row < size; row++)
+				{
+					const long double factor = matrix[row * size + column] / matrix[column * size + column];
+					for (std::size_t k = column; k < size; k++)
+					{
+						matrix[row * size + k] -= factor * matrix[column * size + k];
+					}
+				}
+			}
+
+			return result;
+		}
+
+		/*
+		 * Sets the neighbors across the facets which the given cells share with
+		 * each other.
+		 */
+		void link_cells(const std::vector<std::size_t> & cells)
+		{
+			const std::size_t D = this->_dimension;
+			std::vector<facet_key> & keys = this->_keys;
+			keys.clear();
+
+			for (std::vector<std::size_t>::const_iterator iter = cells.begin(); iter != cells.end(); iter++)
+			{
+				for (std::size_t k = 0; k <= D; k++)
+				{
+					facet_key key;
+					std::fill(key.vertices, key.vertices + MAX_DIMENSION, std::size_t(0));
+					for (std::size_t i = 0, position = 0; i <= D; i++)
+					{
+						if (i != k)
+						{
+							key.vertices[position++] = this->_cell_vertices[*iter * (D + 1) + i];
+						}
+					}
+
+					// an insertion sort of the at most MAX_DIMENSION vertices, whose
+					// bound the compiler can see, unlike that of std::sort
+					for (std::size_t i = 1; i < D && i < MAX_DIMENSION; i++)
+					{
+						const std::size_t vertex = key.vertices[i];
+						std::size_t j = i;
+						for (; j > 0 && key.vertices[j - 1] > vertex; j--)
+						{
+							key.vertices[j] = key.vertices[j - 1];
+						}
+						key.vertices[j] = vertex;
+					}
+
+					key.cell = *iter;
+					key.index = k;
+					keys.push_back(key);
+				}
+			}
+
+			std::sort(keys.begin(), keys.end());
+
+			for (std::size_t i = 0; i + 1 < keys.size(); i++)
+			{
+				if (keys[i].same_facet(keys[i + 1]))
+				{
+					this->_cell_neighbors[keys[i].cell * (D + 1) + keys[i].index] = keys[i + 1].cell;
+					this->_cell_neighbors[keys[i + 1].cell * (D + 1) + keys[i + 1].index] = keys[i].cell;
+					i++;
+				}
+			}
+		}
+
+		std::size_t new_cell(const std::size_t * vertices)
+		{
+			const std::size_t width = this->_dimension + 1;
+			std::size_t cell;
+
+			if (!this->_free_cells.empty())
+			{
+				cell = this->_free_cells.back();
+				this->_free_cells.pop_back();
+				this->_alive[cell] = true;
+				this->_stamps[cell] = 0;
+			}
+			else
+			{
+				cell = this->_alive.size();
+				this->_cell_vertices.resize((cell + 1) * width);
+				this->_cell_neighbors.resize((cell + 1) * width);
+				this->_alive.push_back(true);
+				this->_stamps.push_back(0);
+				this->_in_conflict.push_back(false);
+			}
+
+			std::copy(vertices, vertices + width, this->_cell_vertices.begin() + cell * width);
+			std::fill(this->_cell_neighbors.begin() + cell * width, this->_cell_neighbors.begin() + (cell + 1) * width, this->_no_cell);
+
+			return cell;
+		}
+
+		inline bool is_ghost(const std::size_t c) const
+		{
+			const std::size_t width = this->_dimension + 1;
+			return (std::find(this->_cell_vertices.begin() + c * width, this->_cell_vertices.begin() + (c + 1) * width, this->_infinite_vertex)
+					!= this->_cell_vertices.begin() + (c + 1) * width);
+		}
+
+		inline void mark(const std::size_t c, const bool conflict)
+		{
+			this->_stamps[c] = this->_stamp;
+			this->_in_conflict[c] = conflict;
+		}
+
+		inline unsigned long long next_random()
+		{
+			this->_random_state ^= this->_random_state << 13;
+			this->_random_state ^= this->_random_state >> 7;
+			this->_random_state ^= this->_random_state << 17;
+			return this->_random_state;
+		}
+
+		// a hash of x, uniform in [0, 1)
+		static double uniform_hash(unsigned long long x)
+		{
+			x += 0x9e3779b97f4a7c15ULL;
+			x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+			x ^= x >> 31;
+			return double(x >> 11) / double(1ULL << 53);
+		}
+	};
+
+	template<class T>
+	const double delaunay_triangulation<T>::PERTURBATION = 1e-9;
+
+}
+
+#endif /* DELAUNAY_TRIANGULATION_H_ */
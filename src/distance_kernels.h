@@ -0,0 +1,508 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef DISTANCE_KERNELS_H_
+#define DISTANCE_KERNELS_H_
+
+#include <math.h>
+#include <complex>
+
+#include "metrics.h"
+
+// the vectorized kernels are compiled for their instruction sets with function
+// attributes, so that the rest of the package needs no special flags, and are
+// selected at run time
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || __GNUC__ >= 5)
+#define CPH_DISTANCE_DISPATCH
+#include <immintrin.h>
+#define CPH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define CPH_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+
+namespace cph
+{
+
+	/*
+	 * The distance functions of the metrics of basic_matrix, between two vectors
+	 * x and y of n entries which are stride entries apart.
+	 *
+	 * kernel(metric, p) returns the function for a metric, so that callers
+	 * dispatch on the metric once for a whole block of distances. For double
+	 * precision vectors on x86 processors with AVX2 or AVX-512, the functions
+	 * for contiguous vectors are vectorized, the instruction set being detected
+	 * once at run time. They then sum in a different order than the scalar
+	 * functions, so that the last bits of a distance depend on the processor,
+	 * but a given process always uses the same function.
+	 *
+	 * The minkowski distance is (sum |x_k - y_k|^p)^(1/p), which is a metric for
+	 * p >= 1; the cases p = 1 and p = 2 use the manhattan and euclidean
+	 * functions.
+	 */
+	template<class T>
+	class distance_kernels
+	{
+	private:
+		distance_kernels()
+		{
+		}
+
+	public:
+		typedef T (*kernel_function)(const T * x, const T * y, const std::size_t n, const std::size_t stride, const T p);
+
+		virtual ~distance_kernels()
+		{
+		}
+
+		/*
+		 * The fastest function for vectors with contiguous entries. It must only
+		 * be called with stride 1: the vectorized functions ignore the stride.
+		 */
+		static kernel_function kernel(const metric metric_type, const T p)
+		{
+			return distance_kernels::scalar_kernel(metric_type, p);
+		}
+
+		/*
+		 * The function for vectors with any stride.
+		 */
+		static kernel_function scalar_kernel(const metric metric_type, const T p)
+		{
+			switch (metric_type)
+			{
+				case euclidean:
+					return &distance_kernels::euclidean_distance;
+				case maximum:
+					return &distance_kernels::maximum_distance;
+				case manhattan:
+					return &distance_kernels::manhattan_distance;
+				case canberra:
+					return &distance_kernels::canberra_distance;
+				case binary:
+					return &distance_kernels::binary_distance;
+				case minkowski:
+					return (p == 1 ? &distance_kernels::manhattan_distance : p == 2 ? &distance_kernels::euclidean_distance
+							: &distance_kernels::minkowski_distance);
+			}
+
+			return &distance_kernels::zero_distance;
+		}
+
+		/*
+		 * The name of the instruction set of the functions returned by kernel.
+		 */
+		static const char * instruction_set()
+		{
+			return "scalar";
+		}
+
+		static T euclidean_distance(const T * x, const T * y, const std::size_t n, const std::size_t stride, const T /*p*/)
+		{
+			T sum(0), difference(0);
+			for (std::size_t k = 0; k < n; k++)
+			{
+				difference = x[k * stride] - y[k * stride];
+				sum += difference * difference;
+			}
+
+			return std::sqrt(sum);
+		}
+
+		static T maximum_distance(const T * x, const T * y, const std::size_t n, const std::size_t stride, const T /*p*/)
+		{
+			T max(0), difference(0);
+			for (std::size_t k = 0; k < n; k++)
+			{
+				difference = x[k * stride] - y[k * stride];
+				difference = (difference < 0 ? -difference : difference);
+				max = (difference > max ? difference : max);
+			}
+
+			return max;
+		}
+
+		static T manhattan_distance(const T * x, const T * y, const std::size_t n, const std::size_t stride, const T /*p*/)
+		{
+			T sum(0), difference(0);
+			for (std::size_t k = 0; k < n; k++)
+			{
+				difference = x[k * stride] - y[k * stride];
+				sum += (difference < 0 ? -difference : difference);
+			}
+
+			return sum;
+		}
+
+		static T minkowski_distance(const T * x, const T * y, const std::size_t n, const std::size_t stride, const T p)
+		{
+			T sum(0), difference(0);
+			for (std::size_t k = 0; k < n; k++)
+			{
+				difference = x[k * stride] - y[k * stride];
+				sum += pow(difference < 0 ? -difference : difference, p);
+			}
+
+			return pow(sum, 1.0 / p);
+		}
+
+		static T canberra_distance(const T * x, const T * y, const std::size_t n, const std::size_t stride, const T /*p*/)
+		{
+			T row_sum(0), difference(0), sum(0);
+			for (std::size_t k = 0; k < n; k++)
+			{
+				difference = x[k * stride] - y[k * stride];
+				sum = x[k * stride] + y[k * stride];
+
+				if (sum != 0)
+				{
+					row_sum += (difference < 0 ? -difference : difference) / (sum < 0 ? -sum : sum);
+				}
+			}
+
+			return row_sum;
+		}
+
+		static T binary_distance(const T * x, const T * y, const std::size_t n, const std::size_t stride, const T /*p*/)
+		{
+			std::size_t numerator(0), denominator(0);
+			for (std::size_t k = 0; k < n; k++)
+			{
+				const bool a = (x[k * stride] != 0);
+				const bool b = (y[k * stride] != 0);
+				denominator += (a || b ? 1 : 0);
+				numerator += (a != b ? 1 : 0);
+			}
+
+			return (denominator > 0 ? T(numerator) / T(denominator) : T(0));
+		}
+
+	private:
+		static T zero_distance(const T * /*x*/, const T * /*y*/, const std::size_t /*n*/, const std::size_t /*stride*/, const T /*p*/)
+		{
+			return T(0);
+		}
+
+#ifdef CPH_DISTANCE_DISPATCH
+	public:
+		/*
+		 * The instruction set of the processor, detected on the first call.
+		 */
+		enum instruction_set_level
+		{
+			SCALAR, AVX2, AVX512
+		};
+
+		static instruction_set_level detect()
+		{
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+			{
+				return AVX512;
+			}
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			{
+				return AVX2;
+			}
+			return SCALAR;
+		}
+
+		static instruction_set_level level()
+		{
+			static const instruction_set_level result = distance_kernels::detect();
+			return result;
+		}
+
+	private:
+		CPH_TARGET_AVX2 static inline double sum_256(const __m256d v)
+		{
+			const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+			return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+		}
+
+		CPH_TARGET_AVX2 static inline double max_256(const __m256d v)
+		{
+			const __m128d pair = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+			return _mm_cvtsd_f64(_mm_max_sd(pair, _mm_unpackhi_pd(pair, pair)));
+		}
+
+		CPH_TARGET_AVX2 static inline __m256d abs_256(const __m256d v)
+		{
+			return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+		}
+
+		CPH_TARGET_AVX512 static inline double sum_512(const __m512d v)
+		{
+			double lanes[8];
+			_mm512_storeu_pd(lanes, v);
+			return ((lanes[0] + lanes[4]) + (lanes[2] + lanes[6])) + ((lanes[1] + lanes[5]) + (lanes[3] + lanes[7]));
+		}
+
+		CPH_TARGET_AVX512 static inline double max_512(const __m512d v)
+		{
+			double lanes[8];
+			_mm512_storeu_pd(lanes, v);
+
+			double max(lanes[0]);
+			for (std::size_t k = 1; k < 8; k++)
+			{
+				max = (lanes[k] > max ? lanes[k] : max);
+			}
+			return max;
+		}
+
+		CPH_TARGET_AVX2 static double euclidean_avx2(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			__m256d sum_0 = _mm256_setzero_pd(), sum_1 = _mm256_setzero_pd();
+			std::size_t k(0);
+			for (; k + 8 <= n; k += 8)
+			{
+				const __m256d difference_0 = _mm256_sub_pd(_mm256_loadu_pd(x + k), _mm256_loadu_pd(y + k));
+				const __m256d difference_1 = _mm256_sub_pd(_mm256_loadu_pd(x + k + 4), _mm256_loadu_pd(y + k + 4));
+				sum_0 = _mm256_fmadd_pd(difference_0, difference_0, sum_0);
+				sum_1 = _mm256_fmadd_pd(difference_1, difference_1, sum_1);
+			}
+			for (; k + 4 <= n; k += 4)
+			{
+				const __m256d difference = _mm256_sub_pd(_mm256_loadu_pd(x + k), _mm256_loadu_pd(y + k));
+				sum_0 = _mm256_fmadd_pd(difference, difference, sum_0);
+			}
+
+			double sum = distance_kernels::sum_256(_mm256_add_pd(sum_0, sum_1));
+			for (; k < n; k++)
+			{
+				sum += (x[k] - y[k]) * (x[k] - y[k]);
+			}
+
+			return std::sqrt(sum);
+		}
+
+		CPH_TARGET_AVX2 static double maximum_avx2(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			__m256d max_0 = _mm256_setzero_pd();
+			std::size_t k(0);
+			for (; k + 4 <= n; k += 4)
+			{
+				max_0 = _mm256_max_pd(max_0, distance_kernels::abs_256(_mm256_sub_pd(_mm256_loadu_pd(x + k), _mm256_loadu_pd(y + k))));
+			}
+
+			double max = distance_kernels::max_256(max_0);
+			for (; k < n; k++)
+			{
+				const double difference = std::fabs(x[k] - y[k]);
+				max = (difference > max ? difference : max);
+			}
+
+			return max;
+		}
+
+		CPH_TARGET_AVX2 static double manhattan_avx2(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			__m256d sum_0 = _mm256_setzero_pd(), sum_1 = _mm256_setzero_pd();
+			std::size_t k(0);
+			for (; k + 8 <= n; k += 8)
+			{
+				sum_0 = _mm256_add_pd(sum_0, distance_kernels::abs_256(_mm256_sub_pd(_mm256_loadu_pd(x + k), _mm256_loadu_pd(y + k))));
+				sum_1 = _mm256_add_pd(sum_1, distance_kernels::abs_256(_mm256_sub_pd(_mm256_loadu_pd(x + k + 4), _mm256_loadu_pd(y + k + 4))));
+			}
+			for (; k + 4 <= n; k += 4)
+			{
+				sum_0 = _mm256_add_pd(sum_0, distance_kernels::abs_256(_mm256_sub_pd(_mm256_loadu_pd(x + k), _mm256_loadu_pd(y + k))));
+			}
+
+			double sum = distance_kernels::sum_256(_mm256_add_pd(sum_0, sum_1));
+			for (; k < n; k++)
+			{
+				sum += std::fabs(x[k] - y[k]);
+			}
+
+			return sum;
+		}
+
+		CPH_TARGET_AVX2 static double canberra_avx2(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			__m256d sum_0 = _mm256_setzero_pd();
+			std::size_t k(0);
+			for (; k + 4 <= n; k += 4)
+			{
+				const __m256d a = _mm256_loadu_pd(x + k), b = _mm256_loadu_pd(y + k);
+				const __m256d sum = distance_kernels::abs_256(_mm256_add_pd(a, b));
+				const __m256d nonzero = _mm256_cmp_pd(sum, _mm256_setzero_pd(), _CMP_NEQ_UQ);
+				const __m256d ratio = _mm256_div_pd(distance_kernels::abs_256(_mm256_sub_pd(a, b)), sum);
+				sum_0 = _mm256_add_pd(sum_0, _mm256_and_pd(nonzero, ratio));
+			}
+
+			double row_sum = distance_kernels::sum_256(sum_0);
+			for (; k < n; k++)
+			{
+				const double sum = x[k] + y[k];
+				if (sum != 0)
+				{
+					row_sum += std::fabs(x[k] - y[k]) / std::fabs(sum);
+				}
+			}
+
+			return row_sum;
+		}
+
+		CPH_TARGET_AVX2 static double binary_avx2(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			std::size_t numerator(0), denominator(0);
+			std::size_t k(0);
+			for (; k + 4 <= n; k += 4)
+			{
+				const int a = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(x + k), _mm256_setzero_pd(), _CMP_NEQ_UQ));
+				const int b = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(y + k), _mm256_setzero_pd(), _CMP_NEQ_UQ));
+				denominator += __builtin_popcount(a | b);
+				numerator += __builtin_popcount(a ^ b);
+			}
+			for (; k < n; k++)
+			{
+				const bool a = (x[k] != 0);
+				const bool b = (y[k] != 0);
+				denominator += (a || b ? 1 : 0);
+				numerator += (a != b ? 1 : 0);
+			}
+
+			return (denominator > 0 ? double(numerator) / double(denominator) : 0.0);
+		}
+
+		CPH_TARGET_AVX512 static double euclidean_avx512(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			__m512d sum_0 = _mm512_setzero_pd(), sum_1 = _mm512_setzero_pd();
+			std::size_t k(0);
+			for (; k + 16 <= n; k += 16)
+			{
+				const __m512d difference_0 = _mm512_sub_pd(_mm512_loadu_pd(x + k), _mm512_loadu_pd(y + k));
+				const __m512d difference_1 = _mm512_sub_pd(_mm512_loadu_pd(x + k + 8), _mm512_loadu_pd(y + k + 8));
+				sum_0 = _mm512_fmadd_pd(difference_0, difference_0, sum_0);
+				sum_1 = _mm512_fmadd_pd(difference_1, difference_1, sum_1);
+			}
+			if (k < n)
+			{
+				// the last 1 to 15 entries, with masked loads
+				const __mmask8 mask_0 = distance_kernels::tail_mask(n - k);
+				const __mmask8 mask_1 = distance_kernels::tail_mask(n - k > 8 ? n - k - 8 : 0);
+				const __m512d difference_0 = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask_0, x + k), _mm512_maskz_loadu_pd(mask_0, y + k));
+				const __m512d difference_1 = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask_1, x + k + 8), _mm512_maskz_loadu_pd(mask_1, y + k + 8));
+				sum_0 = _mm512_fmadd_pd(difference_0, difference_0, sum_0);
+				sum_1 = _mm512_fmadd_pd(difference_1, difference_1, sum_1);
+			}
+
+			return std::sqrt(distance_kernels::sum_512(_mm512_add_pd(sum_0, sum_1)));
+		}
+
+		CPH_TARGET_AVX512 static double maximum_avx512(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			__m512d max_0 = _mm512_setzero_pd();
+			for (std::size_t k = 0; k < n; k += 8)
+			{
+				const __mmask8 mask = distance_kernels::tail_mask(n - k);
+				const __m512d difference = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + k), _mm512_maskz_loadu_pd(mask, y + k));
+				max_0 = _mm512_mask_max_pd(max_0, 0xff, max_0, _mm512_abs_pd(difference));
+			}
+
+			return distance_kernels::max_512(max_0);
+		}
+
+		CPH_TARGET_AVX512 static double manhattan_avx512(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			__m512d sum_0 = _mm512_setzero_pd(), sum_1 = _mm512_setzero_pd();
+			std::size_t k(0);
+			for (; k + 16 <= n; k += 16)
+			{
+				sum_0 = _mm512_add_pd(sum_0, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(x + k), _mm512_loadu_pd(y + k))));
+				sum_1 = _mm512_add_pd(sum_1, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(x + k + 8), _mm512_loadu_pd(y + k + 8))));
+			}
+			for (; k < n; k += 8)
+			{
+				const __mmask8 mask = distance_kernels::tail_mask(n - k);
+				sum_0 = _mm512_add_pd(sum_0, _mm512_abs_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + k), _mm512_maskz_loadu_pd(mask, y + k))));
+			}
+
+			return distance_kernels::sum_512(_mm512_add_pd(sum_0, sum_1));
+		}
+
+		CPH_TARGET_AVX512 static double canberra_avx512(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			__m512d sum_0 = _mm512_setzero_pd();
+			for (std::size_t k = 0; k < n; k += 8)
+			{
+				const __mmask8 mask = distance_kernels::tail_mask(n - k);
+				const __m512d a = _mm512_maskz_loadu_pd(mask, x + k), b = _mm512_maskz_loadu_pd(mask, y + k);
+				const __m512d sum = _mm512_abs_pd(_mm512_add_pd(a, b));
+				const __mmask8 nonzero = _mm512_cmp_pd_mask(sum, _mm512_setzero_pd(), _CMP_NEQ_UQ);
+				sum_0 = _mm512_add_pd(sum_0, _mm512_maskz_div_pd(nonzero, _mm512_abs_pd(_mm512_sub_pd(a, b)), sum));
+			}
+
+			return distance_kernels::sum_512(sum_0);
+		}
+
+		CPH_TARGET_AVX512 static double binary_avx512(const double * x, const double * y, const std::size_t n, const std::size_t /*stride*/, const double /*p*/)
+		{
+			std::size_t numerator(0), denominator(0);
+			for (std::size_t k = 0; k < n; k += 8)
+			{
+				const __mmask8 mask = distance_kernels::tail_mask(n - k);
+				const unsigned int a = _mm512_mask_cmp_pd_mask(mask, _mm512_maskz_loadu_pd(mask, x + k), _mm512_setzero_pd(), _CMP_NEQ_UQ);
+				const unsigned int b = _mm512_mask_cmp_pd_mask(mask, _mm512_maskz_loadu_pd(mask, y + k), _mm512_setzero_pd(), _CMP_NEQ_UQ);
+				denominator += __builtin_popcount(a | b);
+				numerator += __builtin_popcount(a ^ b);
+			}
+
+			return (denominator > 0 ? double(numerator) / double(denominator) : 0.0);
+		}
+
+		/*
+		 * The mask of the first min(remaining, 8) lanes.
+		 */
+		static inline __mmask8 tail_mask(const std::size_t remaining)
+		{
+			return __mmask8(remaining >= 8 ? 0xff : (1u << remaining) - 1);
+		}
+
+#endif
+	};
+
+#ifdef CPH_DISTANCE_DISPATCH
+	template<>
+	inline distance_kernels<double>::kernel_function distance_kernels<double>::kernel(const metric metric_type, const double p)
+	{
+		const instruction_set_level current = distance_kernels::level();
+		if (current == SCALAR || (metric_type == minkowski && p != 1 && p != 2))
+		{
+			return distance_kernels::scalar_kernel(metric_type, p);
+		}
+
+		const metric effective = (metric_type == minkowski ? (p == 1 ? manhattan : euclidean) : metric_type);
+		switch (effective)
+		{
+			case euclidean:
+				return (current == AVX512 ? &distance_kernels::euclidean_avx512 : &distance_kernels::euclidean_avx2);
+			case maximum:
+				return (current == AVX512 ? &distance_kernels::maximum_avx512 : &distance_kernels::maximum_avx2);
+			case manhattan:
+				return (current == AVX512 ? &distance_kernels::manhattan_avx512 : &distance_kernels::manhattan_avx2);
+			case canberra:
+				return (current == AVX512 ? &distance_kernels::canberra_avx512 : &distance_kernels::canberra_avx2);
+			case binary:
+				return (current == AVX512 ? &distance_kernels::binary_avx512 : &distance_kernels::binary_avx2);
+			default:
+				return distance_kernels::scalar_kernel(metric_type, p);
+		}
+	}
+
+	template<>
+	inline const char * distance_kernels<double>::instruction_set()
+	{
+		const instruction_set_level current = distance_kernels::level();
+		return (current == AVX512 ? "avx512" : current == AVX2 ? "avx2" : "scalar");
+	}
+#endif
+
+}
+
+#endif /* DISTANCE_KERNELS_H_ */
@@ -0,0 +1,169 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef DTM_RIPS_COMPLEX_H_
+#define DTM_RIPS_COMPLEX_H_
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "flag_complex.h"
+#include "weighted_edge.h"
+#include "spatial_index_factory.h"
+#include "pairwise_distances.h"
+#include "parallel_utility.h"
+
+namespace cph
+{
+
+	/*
+	 * The distance to measure (DTM) filtration of Anai et al., "DTM-based
+	 * filtrations", with p = 1, in the scale of vietoris_rips_complex.
+	 *
+	 * The distance to measure of a point x is the root mean square of its
+	 * distances to its k nearest points, x itself included, and is large for
+	 * outliers. Point x enters the filtration at f(x) = 2 DTM(x), when its ball
+	 * starts growing, and the edge [xy] enters at
+	 *
+	 * max(f(x), f(y), d(x, y) + (f(x) + f(y)) / 2),
+	 *
+	 * when the two balls meet; with k = 1 this is the Vietoris-Rips filtration.
+	 * Outliers thus enter late and have short lived intervals, and the higher
+	 * simplices are those of the flag complex of the edges.
+	 *
+	 * Since an edge never enters before the distance between its vertices, the
+	 * candidate edges are those of the Vietoris-Rips complex with the same
+	 * threshold. The nearest neighbors and the candidate edges are found with a
+	 * spatial index when one is available.
+	 */
+	template<class T>
+	class dtm_rips_complex: public flag_complex<T>
+	{
+	private:
+		const std::size_t _neighbors;
+
+	public:
+		dtm_rips_complex(const finite_metric_space<T> & metric_space, const T & max_filtration_value, const int max_dimension,
+				const std::size_t neighbors) :
+			flag_complex<T> (metric_space, max_filtration_value, max_dimension, metric_space.size(), false), _neighbors(neighbors)
+		{
+		}
+
+		virtual ~dtm_rips_complex()
+		{
+		}
+
+		/*
+		 * The filtration values of the vertices, available once the 1-skeleton
+		 * has been created.
+		 */
+		const std::vector<T> & get_vertex_values() const
+		{
+			return this->_vertex_values;
+		}
+
+		virtual std::vector<weighted_edge<T> > create_1_skeleton()
+		{
+			const std::size_t n = this->_metric_space->size();
+			spatial_index<T> * index = spatial_index_factory::create(*this->_metric_space);
+
+			this->_vertex_values.assign(n, T(0));
+			if (index != 0)
+			{
+				CPH_OMP(parallel)
+				{
+					std::vector<std::pair<std::size_t, T> > neighbors;
+
+					CPH_OMP(for schedule(dynamic, 64))
+					for (std::size_t i = 0; i < n; i++)
+					{
+						index->nearest_neighbors(i, this->_neighbors - 1, neighbors);
+
+						T sum(0);
+						for (typename std::vector<std::pair<std::size_t, T> >::const_iterator iter = neighbors.begin(); iter != neighbors.end(); iter++)
+						{
+							sum += iter->second * iter->second;
+						}
+						this->_vertex_values[i] = 2 * std::sqrt(sum / T(this->_neighbors));
+					}
+				}
+			}
+			else
+			{
+				this->compute_vertex_values();
+			}
+
+			std::vector<weighted_edge<T> > edges = (index != 0 ? index->radius_edges(this->_max_filtration_value)
+					: pairwise_distances::threshold_edges(*this->_metric_space, this->_max_filtration_value));
+			delete (index);
+
+			// the candidate edges are reweighted in one parallel pass, and those
+			// entering past the threshold are dropped
+			const std::vector<T> & f = this->_vertex_values;
+			CPH_OMP(parallel for schedule(static))
+			for (std::size_t e = 0; e < edges.size(); e++)
+			{
+				weighted_edge<T> & edge = edges[e];
+				edge.weight = std::max(std::max(f[edge.i], f[edge.j]), edge.weight + (f[edge.i] + f[edge.j]) / 2);
+			}
+
+			std::size_t kept(0);
+			for (std::size_t e = 0; e < edges.size(); e++)
+			{
+				if (edges[e].weight <= this->_max_filtration_value)
+				{
+					edges[kept++] = edges[e];
+				}
+			}
+			edges.resize(kept);
+
+			return edges;
+		}
+
+	private:
+		/*
+		 * Without an index, the distances from each point to all the points are
+		 * computed, and the nearest ones selected.
+		 */
+		void compute_vertex_values()
+		{
+			const std::size_t n = this->_metric_space->size();
+			const std::size_t k = std::min(this->_neighbors, n);
+
+			CPH_OMP(parallel)
+			{
+				std::vector<T> distances(n);
+
+				CPH_OMP(for schedule(static))
+				for (std::size_t i = 0; i < n; i++)
+				{
+					for (std::size_t column_begin = 0; column_begin < n; column_begin += pairwise_distances::COLUMN_BLOCK)
+					{
+						const std::size_t column_end = (column_begin + pairwise_distances::COLUMN_BLOCK < n ? column_begin
+								+ pairwise_distances::COLUMN_BLOCK : n);
+						this->_metric_space->distances(&i, 1, column_begin, column_end, &distances[column_begin]);
+					}
+					distances[i] = 0;
+
+					std::nth_element(distances.begin(), distances.begin() + (k - 1), distances.end());
+
+					T sum(0);
+					for (std::size_t r = 0; r < k; r++)
+					{
+						sum += distances[r] * distances[r];
+					}
+					this->_vertex_values[i] = 2 * std::sqrt(sum / T(this->_neighbors));
+				}
+			}
+		}
+	};
+
+}
+
+#endif /* DTM_RIPS_COMPLEX_H_ */
@@ -0,0 +1,243 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef EDGE_COLLAPSER_H_
+#define EDGE_COLLAPSER_H_
+
+#include "weighted_edge.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+namespace cph
+{
+
+	/*
+	 * Filtration preserving edge collapses of a weighted graph, following
+	 * Boissonnat and Pritam, "Edge collapse and persistence of flag complexes".
+	 *
+	 * Let G_t be the graph of edges of weight at most t. The edge [uv] is dominated
+	 * in G_t by a vertex w if w is a common neighbor of u and v, and w is adjacent
+	 * to every other common neighbor of u and v. In that case the flag complex of
+	 * G_t collapses onto the flag complex of G_t - [uv].
+	 *
+	 * If [uv] is dominated in G_t for all t in [t_uv, s), then moving the edge from
+	 * t_uv to s does not change the persistence diagram of the flag filtration, and
+	 * if it is dominated for all t >= t_uv, it can be removed altogether. The common
+	 * neighborhood of u and v only changes at the times at which a common neighbor
+	 * enters it, so domination only has to be tested at those times.
+	 *
+	 * The edges are processed in decreasing order of weight, each against the
+	 * current (already collapsed) graph.
+	 */
+	class edge_collapser
+	{
+	private:
+		typedef std::vector<std::pair<std::size_t, std::size_t> > adjacency_list;
+
+		edge_collapser()
+		{
+		}
+
+	public:
+		virtual ~edge_collapser()
+		{
+		}
+
+		template<class T>
+		static std::vector<weighted_edge<T> > collapse(const std::vector<weighted_edge<T> > & edges, const std::size_t vertex_count)
+		{
+			const std::size_t E = edges.size();
+
+			std::vector<T> weights(E);
+			std::vector<bool> removed(E, false);
+			std::vector<adjacency_list> adjacency(vertex_count);
+
+			// neighbor lists hold (neighbor, edge index), sorted by neighbor
+			for (std::size_t e = 0; e < E; e++)
+			{
+				weights[e] = edges[e].weight;
+				adjacency[edges[e].i].push_back(std::make_pair(edges[e].j, e));
+				adjacency[edges[e].j].push_back(std::make_pair(edges[e].i, e));
+			}
+
+			for (std::size_t v = 0; v < vertex_count; v++)
+			{
+				std::sort(adjacency[v].begin(), adjacency[v].end());
+			}
+
+			std::vector<std::pair<T, std::size_t> > order;
+			for (std::size_t e = 0; e < E; e++)
+			{
+				order.push_back(std::make_pair(weights[e], e));
+			}
+			std::sort(order.begin(), order.end(), std::greater<std::pair<T, std::size_t> >());
+
+			std::vector<std::pair<T, std::size_t> > common_neighbors;
+			std::vector<std::size_t> neighborhood;
+
+			for (std::size_t index = 0; index < E; index++)
+			{
+				const std::size_t e = order[index].second;
+				const std::size_t u = edges[e].i;
+				const std::size_t v = edges[e].j;
+				const T t_e = weights[e];
+
+				edge_collapser::get_common_neighbors(adjacency, weights, removed, u, v, common_neighbors);
+
+				neighborhood.clear();
+				std::size_t next(0);
+				bool has_witness(false), dominated(false);
+				std::size_t witness(0);
+				T t = t_e;
+
+				while (true)
+				{
+					const std::size_t previous_size = neighborhood.size();
+					for (; next < common_neighbors.size() && common_neighbors[next].first <= t; next++)
+					{
+						neighborhood.push_back(common_neighbors[next].second);
+					}
+
+					// the current witness only needs to be checked against the new common neighbors
+					for (std::size_t k = previous_size; has_witness && k < neighborhood.size(); k++)
+					{
+						if (!edge_collapser::is_adjacent(adjacency, weights, removed, witness, neighborhood[k], t))
+						{
+							has_witness = false;
+						}
+					}
+
+					if (!has_witness)
+					{
+						has_witness = edge_collapser::find_witness(adjacency, weights, removed, neighborhood, t, witness);
+					}
+
+					if (!has_witness)
+					{
+						break;
+					}
+
+					if (next == common_neighbors.size())
+					{
+						dominated = true;
+						break;
+					}
+
+					t = common_neighbors[next].first;
+				}
+
+				if (dominated)
+				{
+					removed[e] = true;
+				}
+				else if (t > t_e)
+				{
+					weights[e] = t;
+				}
+			}
+
+			std::vector<weighted_edge<T> > result;
+			for (std::size_t e = 0; e < E; e++)
+			{
+				if (!removed[e])
+				{
+					result.push_back(weighted_edge<T> (edges[e].i, edges[e].j, weights[e]));
+				}
+			}
+
+			return result;
+		}
+
+	private:
+		/*
+		 * Collects the common neighbors x of u and v, together with the time
+		 * max(t_ux, t_vx) at which x enters the common neighborhood, sorted by time.
+		 */
+		template<class T>
+		static void get_common_neighbors(const std::vector<adjacency_list> & adjacency, const std::vector<T> & weights, const std::vector<bool> & removed,
+				const std::size_t u, const std::size_t v, std::vector<std::pair<T, std::size_t> > & result)
+		{
+			result.clear();
+
+			const adjacency_list & a = adjacency[u];
+			const adjacency_list & b = adjacency[v];
+
+			std::size_t i(0), j(0);
+			while (i < a.size() && j < b.size())
+			{
+				if (a[i].first < b[j].first)
+				{
+					i++;
+				}
+				else if (b[j].first < a[i].first)
+				{
+					j++;
+				}
+				else
+				{
+					if (!removed[a[i].second] && !removed[b[j].second])
+					{
+						result.push_back(std::make_pair(std::max(weights[a[i].second], weights[b[j].second]), a[i].first));
+					}
+					i++;
+					j++;
+				}
+			}
+
+			std::sort(result.begin(), result.end());
+		}
+
+		template<class T>
+		static bool find_witness(const std::vector<adjacency_list> & adjacency, const std::vector<T> & weights, const std::vector<bool> & removed,
+				const std::vector<std::size_t> & neighborhood, const T t, std::size_t & witness)
+		{
+			for (std::size_t k = 0; k < neighborhood.size(); k++)
+			{
+				const std::size_t w = neighborhood[k];
+				bool dominates(true);
+
+				for (std::size_t l = 0; l < neighborhood.size() && dominates; l++)
+				{
+					if (l != k && !edge_collapser::is_adjacent(adjacency, weights, removed, w, neighborhood[l], t))
+					{
+						dominates = false;
+					}
+				}
+
+				if (dominates)
+				{
+					witness = w;
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		template<class T>
+		static inline bool is_adjacent(const std::vector<adjacency_list> & adjacency, const std::vector<T> & weights, const std::vector<bool> & removed,
+				const std::size_t x, const std::size_t y, const T t)
+		{
+			const adjacency_list & a = adjacency[x];
+			typename adjacency_list::const_iterator iter = std::lower_bound(a.begin(), a.end(), std::make_pair(y, std::size_t(0)));
+
+			if (iter == a.end() || iter->first != y || removed[iter->second])
+			{
+				return false;
+			}
+
+			return (weights[iter->second] <= t);
+		}
+	};
+
+}
+
+#endif /* EDGE_COLLAPSER_H_ */
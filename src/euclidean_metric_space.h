@@ -10,15 +10,36 @@
 #define EUCLIDEAN_METRIC_SPACE_H_
 
 #include "basic_matrix.h"
+#include "blocked_gemm.h"
 #include "utility.h"
 #include "finite_metric_space.h"
 #include "metrics.h"
+#include "parallel_utility.h"
 
 #include <algorithm>
+#include <vector>
+#include <cmath>
+#include <limits>
 
 namespace cph
 {
 
+	/*
+	 * The points given by the rows of a matrix, under one of the metrics of
+	 * basic_matrix.
+	 *
+	 * For the euclidean metric on contiguous rows of at least GRAM_COLUMNS
+	 * coordinates, blocks of distances can also be computed from the Gram
+	 * matrix, as ||x||^2 + ||y||^2 - 2 <x, y>, the dot products coming from
+	 * blocked_gemm. This does most of the work in a matrix multiplication, but
+	 * loses accuracy to cancellation when the points are close compared to
+	 * their norms. The points are therefore centered on their mean, the
+	 * squares which cancel below zero are clamped to zero, and these distances
+	 * are only used where a bound on their error is enough:
+	 * threshold_distances uses them to rule out the pairs which are surely above
+	 * the threshold and computes the others exactly, and approximate_distances
+	 * returns them as they are.
+	 */
 	template<class T>
 	class euclidean_metric_space: public finite_metric_space<T>
 	{
@@ -27,10 +48,28 @@ namespace cph
 		const basic_matrix<T> * _points;
 		const metric _metric_type;
 		const T _p;
+
+		// the distance function, chosen once for the metric
+		const typename distance_kernels<T>::kernel_function _kernel;
+
+		// the mean of the points, and the squared norms of the centered points,
+		// for the Gram matrix distances
+		std::vector<T> _center;
+		std::vector<T> _squared_norms;
+
 	public:
+		// the fewest coordinates, and rows per block, for which the Gram matrix
+		// distances pay off
+		static const std::size_t GRAM_COLUMNS = 16;
+		static const std::size_t GRAM_ROWS = 8;
+
 		euclidean_metric_space(const basic_matrix<T> * points, const metric metric_type = euclidean, const T p = 2) :
-			_points(points), _metric_type(metric_type), _p(p)
+			_points(points), _metric_type(metric_type), _p(p), _kernel(points->distance_kernel(metric_type, p))
 		{
+			if (this->has_gram_distances())
+			{
+				this->compute_squared_norms();
+			}
 		}
 
 		virtual ~euclidean_metric_space()
@@ -40,7 +79,7 @@ namespace cph
 
 		const T distance(const std::size_t i, const std::size_t j) const
 		{
-			return this->_points->row_distance(i, j, this->_metric_type, this->_p);
+			return this->_points->row_distance(i, j, this->_kernel, this->_p);
 		}
 
 		const std::size_t size() const
@@ -48,6 +87,174 @@ namespace cph
 			return _points->rows();
 		}
 
+		void distances(const std::size_t * rows, const std::size_t row_count, const std::size_t column_begin, const std::size_t column_end, T * result) const
+		{
+			for (std::size_t r = 0; r < row_count; r++)
+			{
+				for (std::size_t j = column_begin; j < column_end; j++)
+				{
+					*(result++) = this->_points->row_distance(rows[r], j, this->_kernel, this->_p);
+				}
+			}
+		}
+
+		/*
+		 * Tells apart the pairs above threshold from their Gram matrix distance
+		 * and the bound on its error, and computes the other distances exactly,
+		 * so that the distances up to threshold are those of distance.
+		 */
+		void threshold_distances(const std::size_t * rows, const std::size_t row_count, const std::size_t column_begin, const std::size_t column_end,
+				const T threshold, T * result) const
+		{
+			const T squared_threshold = threshold * threshold * (1 + T(1e-10));
+			if (row_count < GRAM_ROWS || !this->has_gram_distances() || !(squared_threshold < std::numeric_limits<T>::max()))
+			{
+				this->distances(rows, row_count, column_begin, column_end, result);
+				return;
+			}
+
+			this->squared_gram_distances(rows, row_count, column_begin, column_end, result);
+
+			const T error_scale = this->gram_error_scale();
+			for (std::size_t r = 0; r < row_count; r++)
+			{
+				for (std::size_t j = column_begin; j < column_end; j++, result++)
+				{
+					if (*result <= squared_threshold + error_scale * (this->_squared_norms[rows[r]] + this->_squared_norms[j]))
+					{
+						*result = this->_points->row_distance(rows[r], j, this->_kernel, this->_p);
+					}
+					else
+					{
+						*result = std::sqrt(*result);
+					}
+				}
+			}
+		}
+
+		void approximate_distances(const std::size_t * rows, const std::size_t row_count, const std::size_t column_begin,
+				const std::size_t column_end, T * result) const
+		{
+			if (row_count < GRAM_ROWS || !this->has_gram_distances())
+			{
+				this->distances(rows, row_count, column_begin, column_end, result);
+				return;
+			}
+
+			this->squared_gram_distances(rows, row_count, column_begin, column_end, result);
+
+			for (std::size_t r = 0; r < row_count; r++)
+			{
+				for (std::size_t j = column_begin; j < column_end; j++, result++)
+				{
+					*result = (rows[r] == j || *result <= 0 ? T(0) : std::sqrt(*result));
+				}
+			}
+		}
+
+		/*
+		 * Whether blocks of distances are computed from the Gram matrix.
+		 */
+		bool has_gram_distances() const
+		{
+			return (this->_metric_type == euclidean && this->_points->layout() == row_major && this->_points->columns() >= GRAM_COLUMNS);
+		}
+
+		const basic_matrix<T> & points() const
+		{
+			return *(this->_points);
+		}
+
+		const metric metric_type() const
+		{
+			return this->_metric_type;
+		}
+
+		const T p() const
+		{
+			return this->_p;
+		}
+
+	private:
+		void compute_squared_norms()
+		{
+			const std::size_t n = this->_points->rows();
+			const std::size_t d = this->_points->columns();
+
+			this->_center.assign(d, T(0));
+			for (std::size_t i = 0; i < n; i++)
+			{
+				const T * x = this->_points->row(i);
+				for (std::size_t k = 0; k < d; k++)
+				{
+					this->_center[k] += x[k];
+				}
+			}
+			for (std::size_t k = 0; k < d; k++)
+			{
+				this->_center[k] /= T(n);
+			}
+
+			// the norms are those of the centered coordinates as blocked_gemm rounds them
+			this->_squared_norms.resize(n);
+			CPH_OMP(parallel for schedule(static))
+			for (std::size_t i = 0; i < n; i++)
+			{
+				const T * x = this->_points->row(i);
+				T sum(0);
+				for (std::size_t k = 0; k < d; k++)
+				{
+					const T centered = x[k] - this->_center[k];
+					sum += centered * centered;
+				}
+				this->_squared_norms[i] = sum;
+			}
+		}
+
+		/*
+		 * Writes ||x||^2 + ||y||^2 - 2 <x, y> for the centered points, which may
+		 * be slightly negative, in the layout of distances.
+		 */
+		void squared_gram_distances(const std::size_t * rows, const std::size_t row_count, const std::size_t column_begin,
+				const std::size_t column_end, T * result) const
+		{
+			const std::size_t column_count = column_end - column_begin;
+
+			std::vector<const T *> x(row_count), y(column_count);
+			for (std::size_t r = 0; r < row_count; r++)
+			{
+				x[r] = this->_points->row(rows[r]);
+			}
+			for (std::size_t j = 0; j < column_count; j++)
+			{
+				y[j] = this->_points->row(column_begin + j);
+			}
+
+			blocked_gemm<T>::multiply(&x[0], row_count, column_count == 0 ? 0 : &y[0], column_count, this->_points->columns(), &this->_center[0], result);
+
+			for (std::size_t r = 0; r < row_count; r++)
+			{
+				const T x_norm = this->_squared_norms[rows[r]];
+				for (std::size_t j = column_begin; j < column_end; j++, result++)
+				{
+					*result = x_norm + this->_squared_norms[j] - 2 * *result;
+				}
+			}
+		}
+
+		/*
+		 * The squared Gram matrix distance of two points is within this times the
+		 * sum of their squared norms of the exact one: the dot product and the
+		 * norms of d coordinates each have a relative error of at most about d
+		 * units in the last place, and 2 |<x, y>| <= ||x||^2 + ||y||^2. The
+		 * bound is doubled for safety.
+		 */
+		T gram_error_scale() const
+		{
+			return 4 * T(this->_points->columns() + 4) * std::numeric_limits<T>::epsilon();
+		}
+
+	public:
 		template<class S>
 		friend S & operator <<(S & s, const euclidean_metric_space<T> & value)
 		{
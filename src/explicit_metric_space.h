@@ -9,6 +9,8 @@
 #define EXPLICIT_METRIC_SPACE_HPP_
 
 #include "finite_metric_space.h"
+#include "basic_matrix.h"
+
 namespace cph
 {
 
@@ -40,6 +42,34 @@ namespace cph
 			return _distance_matrix->rows();
 		}
 
+		/*
+		 * The block is read along the layout of the matrix, which is column major
+		 * when it is a view of an R matrix.
+		 */
+		void distances(const std::size_t * rows, const std::size_t row_count, const std::size_t column_begin, const std::size_t column_end, T * result) const
+		{
+			if (this->_distance_matrix->layout() == column_major)
+			{
+				const std::size_t width = column_end - column_begin;
+				for (std::size_t j = column_begin; j < column_end; j++)
+				{
+					for (std::size_t r = 0; r < row_count; r++)
+					{
+						result[r * width + (j - column_begin)] = this->_distance_matrix->operator()(rows[r], j);
+					}
+				}
+				return;
+			}
+
+			for (std::size_t r = 0; r < row_count; r++)
+			{
+				for (std::size_t j = column_begin; j < column_end; j++)
+				{
+					*(result++) = this->_distance_matrix->operator()(rows[r], j);
+				}
+			}
+		}
+
 		template<class S>
 		friend S & operator <<(S & s, const explicit_metric_space<T> & value)
 		{
@@ -28,23 +28,43 @@ namespace cph
 		virtual const T distance(const std::size_t i, const std::size_t j) const = 0;
 		virtual const std::size_t size() const = 0;
 
-		const T estimate_diameter(const std::size_t samples = 100) const
+		/*
+		 * Writes distance(rows[r], j) for r < row_count and column_begin <= j <
+		 * column_end to result, row by row. This is the building block of the
+		 * tiled kernels in pairwise_distances; subclasses which can compute a
+		 * whole block without a virtual call per pair should override it.
+		 */
+		virtual void distances(const std::size_t * rows, const std::size_t row_count, const std::size_t column_begin, const std::size_t column_end,
+				T * result) const
 		{
-			T max(0), distance(0);
-
-			for (std::size_t s = 0; s < samples; s++)
+			for (std::size_t r = 0; r < row_count; r++)
 			{
-				std::size_t i = random_utility::random_integer(0, this->size() - 1);
-				std::size_t j = random_utility::random_integer(0, this->size() - 1);
-
-				distance = this->distance(i, j);
-				if (distance > max)
+				for (std::size_t j = column_begin; j < column_end; j++)
 				{
-					max = distance;
+					*(result++) = this->distance(rows[r], j);
 				}
 			}
+		}
 
-			return max;
+		/*
+		 * As distances, except that the distances above threshold need only be
+		 * some value above threshold. This lets a subclass rule out far away
+		 * pairs with a cheaper estimate.
+		 */
+		virtual void threshold_distances(const std::size_t * rows, const std::size_t row_count, const std::size_t column_begin,
+				const std::size_t column_end, const T threshold, T * result) const
+		{
+			this->distances(rows, row_count, column_begin, column_end, result);
+		}
+
+		/*
+		 * As distances, up to rounding errors which may be larger than those of
+		 * distance, for callers which do not need the two to agree exactly.
+		 */
+		virtual void approximate_distances(const std::size_t * rows, const std::size_t row_count, const std::size_t column_begin,
+				const std::size_t column_end, T * result) const
+		{
+			this->distances(rows, row_count, column_begin, column_end, result);
 		}
 	};
 
@@ -11,10 +11,22 @@
 
 #include "simplex.h"
 #include "simplex_stream.h"
-#include "basic_graph.h"
+#include "csr_graph.h"
+#include "bitset_graph.h"
+#include "weighted_edge.h"
+#include "edge_collapser.h"
+#include "flag_filtration_generator.h"
 #include "finite_metric_space.h"
+#include "random_utility.h"
+#include "parallel_utility.h"
+#include "sorted_intersection.h"
+#include "complex_size_estimate.h"
 
 #include <algorithm>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <functional>
 
 namespace cph
 {
@@ -24,15 +36,36 @@ namespace cph
 	{
 
 	protected:
-		const finite_metric_space<T> & _metric_space;
+		const finite_metric_space<T> * _metric_space;
 		const T _max_filtration_value;
 		const std::size_t _max_dimension;
-		const std::size_t _vertex_set_size;
+		std::size_t _vertex_set_size;
+		const bool _collapse_edges;
+
+		/*
+		 * If not empty, the time after which no simplex containing the vertex can
+		 * enter the filtration. A simplex whose filtration value exceeds the deletion
+		 * time of one of its vertices is left out, together with its cofaces.
+		 */
+		std::vector<T> _vertex_deletion_times;
+
+		/*
+		 * If not empty, the filtration value of each vertex, which must not exceed
+		 * the weights of its edges; otherwise every vertex enters at 0. A vertex
+		 * entering after the maximum filtration value is left out. The values are
+		 * only used by construct(), not by the filtration generator.
+		 */
+		std::vector<T> _vertex_values;
+
+		typedef std::vector<std::pair<T, simplex<std::size_t> > > simplex_buffer;
+		typedef std::vector<std::vector<std::size_t> > neighbor_lists;
+		typedef std::vector<weighted_edge<T> > edge_list;
 
 	public:
 		flag_complex(const finite_metric_space<T> & metric_space, const T & max_filtration_value, const std::size_t max_dimension,
-				const std::size_t vertex_set_size) :
-			_metric_space(metric_space), _max_filtration_value(max_filtration_value), _max_dimension(max_dimension), _vertex_set_size(vertex_set_size)
+				const std::size_t vertex_set_size, const bool collapse_edges = false) :
+			_metric_space(&metric_space), _max_filtration_value(max_filtration_value), _max_dimension(max_dimension), _vertex_set_size(vertex_set_size),
+					_collapse_edges(collapse_edges)
 		{
 		}
 
@@ -42,30 +75,199 @@ namespace cph
 
 		void construct()
 		{
-			basic_graph<T> * graph = this->create_1_skeleton();
-			this->incremental_expansion(graph, this->_max_dimension);
-			this->ensure_sorted();
-			delete (graph);
+			this->expand(this->build_1_skeleton());
+		}
+
+		/*
+		 * The 1-skeleton of the complex as an edge list, after the optional edge
+		 * collapses. This is all that is needed for 0-dimensional persistence.
+		 */
+		edge_list get_1_skeleton()
+		{
+			return this->build_1_skeleton();
+		}
+
+		/*
+		 * Instead of constructing the complex, returns a generator that produces
+		 * its simplices in filtration order. The caller owns the generator.
+		 */
+		flag_filtration_generator<T> * create_filtration_generator()
+		{
+			const edge_list edges = this->build_1_skeleton();
+			return new flag_filtration_generator<T> (edges, this->_vertex_set_size, this->_max_dimension, this->_vertex_deletion_times);
+		}
+
+		/*
+		 * Returns the number of simplices of each dimension of the complex without
+		 * storing any of them. If sample_size is positive and smaller than the
+		 * number of vertices, only the cofaces rooted at sample_size randomly chosen
+		 * vertices are counted, and the counts are scaled up accordingly. Since every
+		 * simplex is rooted at exactly one vertex (its largest), this is an unbiased
+		 * estimate.
+		 */
+		std::vector<double> count_simplices(const std::size_t sample_size = 0)
+		{
+			const edge_list edges = this->build_1_skeleton();
+
+			if (bitset_graph<T>::is_dense(edges.size(), this->_vertex_set_size))
+			{
+				return this->count_simplices(bitset_graph<T> (edges, this->_vertex_set_size), sample_size);
+			}
+
+			return this->count_simplices(csr_graph<T> (edges, this->_vertex_set_size), sample_size);
+		}
+
+		/*
+		 * Rough number of bytes held while the complex is constructed: the stream
+		 * stores every simplex twice (in the ordered list and as the key of its
+		 * filtration value), and the expansion buffers hold up to two more copies
+		 * while they are merged.
+		 */
+		static double projected_construction_memory(const std::vector<double> & simplex_counts)
+		{
+			double bytes(0);
+			for (std::size_t d = 0; d < simplex_counts.size(); d++)
+			{
+				const double simplex_bytes = sizeof(simplex<std::size_t> ) + complex_size_estimate::HEAP_OVERHEAD + (d + 1) * sizeof(std::size_t);
+				const double map_node_bytes = complex_size_estimate::TREE_NODE_OVERHEAD + sizeof(T);
+				bytes += simplex_counts[d] * (4 * simplex_bytes + map_node_bytes + 2 * sizeof(T));
+			}
+			return bytes;
 		}
 
 	protected:
-		virtual basic_graph<T> * create_1_skeleton() = 0;
+		virtual edge_list create_1_skeleton() = 0;
+
+		template<class G>
+		std::vector<double> count_simplices(const G & graph, const std::size_t sample_size) const
+		{
+			std::vector<std::size_t> roots;
+			const bool sampled = (sample_size > 0 && sample_size < this->_vertex_set_size);
+			for (std::size_t r = 0; r < (sampled ? sample_size : this->_vertex_set_size); r++)
+			{
+				roots.push_back(sampled ? random_utility::random_integer(0, this->_vertex_set_size - 1) : r);
+			}
+
+			const std::size_t k = this->_max_dimension;
+			std::vector<std::vector<double> > thread_counts(parallel_utility::max_threads(), std::vector<double>(k + 1, 0));
+
+			CPH_OMP(parallel)
+			{
+				std::vector<double> & counts = thread_counts[parallel_utility::thread_index()];
+				std::vector<std::vector<typename G::neighbor_set_element> > scratch(k + 1,
+						std::vector<typename G::neighbor_set_element>(graph.max_lower_neighbors_size()));
+
+				CPH_OMP(for schedule(dynamic, 1))
+				for (std::size_t r = 0; r < roots.size(); r++)
+				{
+					const std::size_t u = roots[r];
+					this->count_cofaces(graph, k, 0, graph.lower_neighbors(u), graph.lower_neighbors_size(u), scratch, counts);
+				}
+			}
+
+			std::vector<double> result(k + 1, 0);
+			const double scale = (sampled ? double(this->_vertex_set_size) / double(sample_size) : 1.0);
+			for (std::size_t t = 0; t < thread_counts.size(); t++)
+			{
+				for (std::size_t d = 0; d <= k; d++)
+				{
+					result[d] += scale * thread_counts[t][d];
+				}
+			}
+
+			return result;
+		}
+
+		edge_list build_1_skeleton()
+		{
+			if (this->_collapse_edges)
+			{
+				return edge_collapser::collapse(this->create_1_skeleton(), this->_vertex_set_size);
+			}
 
-		void incremental_expansion(basic_graph<T> * graph, const std::size_t k)
+			return this->create_1_skeleton();
+		}
+
+		/*
+		 * Expands the given 1-skeleton, on a bit matrix when it is dense, and on
+		 * sorted neighbor arrays otherwise.
+		 */
+		void expand(const edge_list & edges, const std::size_t first_vertex = 0)
 		{
+			if (bitset_graph<T>::is_dense(edges.size(), this->_vertex_set_size))
+			{
+				bitset_graph<T> graph(edges, this->_vertex_set_size);
+				this->incremental_expansion(graph, this->_max_dimension, first_vertex);
+			}
+			else
+			{
+				csr_graph<T> graph(edges, this->_vertex_set_size);
+				this->incremental_expansion(graph, this->_max_dimension, first_vertex);
+			}
+		}
+
+		/*
+		 * The cofaces rooted at different vertices are disjoint, so the expansion
+		 * is run in parallel over the vertex set. Each thread writes into its own
+		 * buffer, which it sorts in filtration order; the sorted buffers are then
+		 * merged and appended to the stream, so that no further sorting is needed.
+		 *
+		 * The lower neighbors of each vertex are read in place from the rows of the
+		 * graph, and the candidate sets of the recursion live in per-thread scratch
+		 * arrays, one per depth, so the expansion does not allocate any sets.
+		 *
+		 * Only the cofaces whose largest vertex is at least first_vertex are added.
+		 */
+		template<class G>
+		void incremental_expansion(const G & graph, const std::size_t k, const std::size_t first_vertex = 0)
+		{
+
+			// The degrees of Rips graphs are very skewed. Dynamic scheduling takes care
+			// of balancing, and starting with the heaviest vertices keeps a large subtree
+			// from being picked up last.
+			std::vector<std::pair<std::size_t, std::size_t> > roots;
 			for (std::size_t u = 0; u < this->_vertex_set_size; u++)
 			{
-				std::set<std::size_t> * lower_neighbors = graph->lower_neighbors(u);
-				this->add_cofaces(graph, k, simplex<std::size_t>::make_simplex(u), lower_neighbors, 0);
-				delete (lower_neighbors);
+				if (u >= first_vertex && (this->_vertex_values.empty() || this->_vertex_values[u] <= this->_max_filtration_value))
+				{
+					roots.push_back(std::make_pair(graph.lower_degree(u), u));
+				}
+			}
+			std::sort(roots.begin(), roots.end(), std::greater<std::pair<std::size_t, std::size_t> >());
+
+			std::vector<simplex_buffer> buffers(parallel_utility::max_threads());
+
+			CPH_OMP(parallel)
+			{
+				simplex_buffer & buffer = buffers[parallel_utility::thread_index()];
+				std::vector<std::vector<typename G::neighbor_set_element> > scratch(k + 1,
+						std::vector<typename G::neighbor_set_element>(graph.max_lower_neighbors_size()));
+
+				CPH_OMP(for schedule(dynamic, 1))
+				for (std::size_t r = 0; r < roots.size(); r++)
+				{
+					const std::size_t u = roots[r].second;
+					this->add_cofaces(graph, k, simplex<std::size_t>::make_simplex(u), graph.lower_neighbors(u), graph.lower_neighbors_size(u),
+							this->vertex_value(u), scratch, buffer);
+				}
+
+				std::sort(buffer.begin(), buffer.end(), ordered_comparison<T, simplex<std::size_t> > ());
 			}
+
+			this->merge_buffers(buffers);
 		}
 
-		void add_cofaces(basic_graph<T> * graph, const std::size_t k, const simplex<std::size_t> & tau, const std::set<std::size_t> * N,
-				const T filtration_value)
+		/*
+		 * N is the sorted array of common lower neighbors of the vertices of tau.
+		 * The candidates for the cofaces of tau + v are the elements of N below v
+		 * which are lower neighbors of v; they are written to the scratch array
+		 * of the next depth.
+		 */
+		void add_cofaces(const csr_graph<T> & graph, const std::size_t k, const simplex<std::size_t> & tau,
+				const std::size_t * N, const std::size_t N_size, const T filtration_value, neighbor_lists & scratch, simplex_buffer & buffer) const
 		{
 
-			this->add_simplex(tau, filtration_value);
+			buffer.push_back(std::make_pair(filtration_value, tau));
 
 			if (tau.dimension() >= k)
 			{
@@ -74,36 +276,202 @@ namespace cph
 
 			T weight(0);
 
-			for (typename std::set<std::size_t>::iterator iterator = N->begin(); iterator != N->end(); ++iterator)
+			for (std::size_t index = 0; index < N_size; index++)
 			{
-				std::size_t v = (*iterator);
+				std::size_t v = N[index];
 
 				simplex<std::size_t> sigma = tau.append_to(v);
 
-				std::set<std::size_t> * M = graph->intersect_with_lower_neighbors(*N, v);
+				std::size_t * M = &scratch[tau.dimension() + 1][0];
+				std::size_t M_size = sorted_intersection::intersect(N, index, graph.lower_neighbors(v), graph.lower_degree(v), M);
 
 				if (sigma.dimension() == 1)
 				{
 					const std::size_t i = sigma[0];
 					const std::size_t j = sigma[1];
-					weight = graph->get_weight(i, j);
+					weight = graph.get_weight(i, j);
 				}
 				else if (sigma.dimension() > 1)
 				{
 					weight = filtration_value;
 					for (std::size_t i = 0; i < tau.dimension() + 1; i++)
 					{
-						weight = std::max(weight, graph->get_weight(tau[i], v));
+						weight = std::max(weight, graph.get_weight(tau[i], v));
 					}
 				}
 
-				this->add_cofaces(graph, k, sigma, M, weight);
+				if (!this->is_admissible(sigma, weight))
+				{
+					continue;
+				}
 
-				delete (M);
+				this->add_cofaces(graph, k, sigma, M, M_size, weight, scratch, buffer);
 			}
 
 		}
 
+		/*
+		 * The same recursion on a bit matrix: N is the bitset of common lower
+		 * neighbors of the vertices of tau, of N_words words, and the candidates for
+		 * the cofaces of tau + v are N & (lower neighbors of v), which only has bits
+		 * below v.
+		 */
+		void add_cofaces(const bitset_graph<T> & graph, const std::size_t k, const simplex<std::size_t> & tau, const word_bitset::word * N,
+				const std::size_t N_words, const T filtration_value, std::vector<std::vector<word_bitset::word> > & scratch,
+				simplex_buffer & buffer) const
+		{
+			buffer.push_back(std::make_pair(filtration_value, tau));
+
+			if (tau.dimension() >= k)
+			{
+				return;
+			}
+
+			for (std::size_t w = 0; w < N_words; w++)
+			{
+				for (word_bitset::word bits = N[w]; bits != 0; bits &= bits - 1)
+				{
+					const std::size_t v = w * word_bitset::WORD_BITS + word_bitset::lowest_bit(bits);
+
+					simplex<std::size_t> sigma = tau.append_to(v);
+
+					word_bitset::word * M = &scratch[tau.dimension() + 1][0];
+					const std::size_t M_words = (sigma.dimension() < k ? graph.lower_neighbors_size(v) : 0);
+					word_bitset::intersect(N, graph.lower_neighbors(v), M_words, M);
+
+					T weight = filtration_value;
+					for (std::size_t i = 0; i < tau.dimension() + 1; i++)
+					{
+						weight = std::max(weight, graph.get_weight(tau[i], v));
+					}
+
+					if (!this->is_admissible(sigma, weight))
+					{
+						continue;
+					}
+
+					this->add_cofaces(graph, k, sigma, M, M_words, weight, scratch, buffer);
+				}
+			}
+		}
+
+		void count_cofaces(const csr_graph<T> & graph, const std::size_t k, const std::size_t depth, const std::size_t * N,
+				const std::size_t N_size, neighbor_lists & scratch, std::vector<double> & counts) const
+		{
+			counts[depth] += 1;
+
+			if (depth >= k)
+			{
+				return;
+			}
+
+			// the cofaces of top dimension need not be visited one at a time
+			if (depth + 1 == k)
+			{
+				counts[k] += N_size;
+				return;
+			}
+
+			for (std::size_t index = 0; index < N_size; index++)
+			{
+				std::size_t * M = &scratch[depth + 1][0];
+				std::size_t M_size = sorted_intersection::intersect(N, index, graph.lower_neighbors(N[index]), graph.lower_degree(N[index]), M);
+				this->count_cofaces(graph, k, depth + 1, M, M_size, scratch, counts);
+			}
+		}
+
+		void count_cofaces(const bitset_graph<T> & graph, const std::size_t k, const std::size_t depth, const word_bitset::word * N,
+				const std::size_t N_words, std::vector<std::vector<word_bitset::word> > & scratch, std::vector<double> & counts) const
+		{
+			counts[depth] += 1;
+
+			if (depth >= k)
+			{
+				return;
+			}
+
+			if (depth + 1 == k)
+			{
+				counts[k] += word_bitset::count(N, N_words);
+				return;
+			}
+
+			for (std::size_t w = 0; w < N_words; w++)
+			{
+				for (word_bitset::word bits = N[w]; bits != 0; bits &= bits - 1)
+				{
+					const std::size_t v = w * word_bitset::WORD_BITS + word_bitset::lowest_bit(bits);
+					word_bitset::word * M = &scratch[depth + 1][0];
+					word_bitset::intersect(N, graph.lower_neighbors(v), graph.lower_neighbors_size(v), M);
+					this->count_cofaces(graph, k, depth + 1, M, graph.lower_neighbors_size(v), scratch, counts);
+				}
+			}
+		}
+
+		inline T vertex_value(const std::size_t u) const
+		{
+			return (this->_vertex_values.empty() ? T(0) : this->_vertex_values[u]);
+		}
+
+		inline bool is_admissible(const simplex<std::size_t> & sigma, const T filtration_value) const
+		{
+			if (this->_vertex_deletion_times.empty())
+			{
+				return true;
+			}
+
+			for (std::size_t i = 0; i < sigma.dimension() + 1; i++)
+			{
+				if (filtration_value > this->_vertex_deletion_times[sigma[i]])
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		/*
+		 * Appends the simplices in the sorted buffers to the stream. If the stream
+		 * already holds (sorted) simplices, the two sorted ranges are merged.
+		 */
+		void merge_buffers(std::vector<simplex_buffer> & buffers)
+		{
+			const std::size_t previous_size = this->size();
+
+			// pairwise merge of the sorted per-thread buffers
+			for (std::size_t width = 1; width < buffers.size(); width *= 2)
+			{
+				for (std::size_t i = 0; i + width < buffers.size(); i += 2 * width)
+				{
+					simplex_buffer & first = buffers[i];
+					simplex_buffer & second = buffers[i + width];
+					simplex_buffer merged;
+					merged.reserve(first.size() + second.size());
+					std::merge(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(merged),
+							ordered_comparison<T, simplex<std::size_t> > ());
+					first.swap(merged);
+					simplex_buffer().swap(second);
+				}
+			}
+
+			if (buffers.empty())
+			{
+				return;
+			}
+
+			for (typename simplex_buffer::const_iterator iter = buffers[0].begin(); iter != buffers[0].end(); iter++)
+			{
+				this->add_simplex(iter->second, iter->first);
+			}
+
+			if (previous_size > 0)
+			{
+				this->merge_sorted_suffix(previous_size);
+			}
+		}
+
 	};
 }
 
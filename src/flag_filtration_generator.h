@@ -0,0 +1,243 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef FLAG_FILTRATION_GENERATOR_H_
+#define FLAG_FILTRATION_GENERATOR_H_
+
+#include "simplex.h"
+#include "weighted_edge.h"
+#include "sorted_intersection.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace cph
+{
+
+	/*
+	 * Produces the simplices of the flag complex of a weighted graph in
+	 * filtration order, in batches, without constructing the whole complex.
+	 *
+	 * The vertices come first. The edges are then visited in increasing order of
+	 * weight, and every edge e = [ij] is followed by the cliques in which it is the
+	 * last edge, i.e. the cliques of [ij] together with common neighbors reached
+	 * through earlier edges. These all have the filtration value of e. Within an
+	 * edge the cliques are enumerated depth first, towards smaller vertices, so
+	 * every face of a clique is produced before the clique itself.
+	 *
+	 * The depth first search is kept on an explicit stack of at most
+	 * max_dimension frames, so that a batch can end in the middle of the
+	 * cliques of an edge and the next batch resumes there.
+	 */
+	template<class T>
+	class flag_filtration_generator
+	{
+	public:
+		typedef std::vector<std::pair<T, simplex<std::size_t> > > simplex_buffer;
+
+	private:
+		// (neighbor, rank of the edge to it), sorted by neighbor
+		typedef std::vector<std::pair<std::size_t, std::size_t> > ranked_adjacency;
+
+		/*
+		 * A simplex tau of the search, whose cofaces tau + v are taken from the
+		 * candidates in _scratch[tau.dimension()], starting at index.
+		 */
+		struct coface_frame
+		{
+			simplex<std::size_t> tau;
+			std::size_t size;
+			std::size_t index;
+
+			coface_frame(const simplex<std::size_t> & tau, const std::size_t size) :
+				tau(tau), size(size), index(0)
+			{
+			}
+		};
+
+		const std::size_t _vertex_count;
+		const std::size_t _max_dimension;
+
+		std::vector<weighted_edge<T> > _edges;
+		std::vector<ranked_adjacency> _adjacency;
+		const std::vector<T> _vertex_deletion_times;
+
+		std::size_t _next_vertex;
+		std::size_t _next_edge;
+
+		// the search through the cliques of the edge of rank _next_edge - 1
+		std::vector<coface_frame> _frames;
+
+		std::vector<std::vector<std::size_t> > _scratch;
+		std::vector<std::size_t> _earlier_neighbors, _other_earlier_neighbors;
+
+	public:
+		/*
+		 * The optional vertex deletion times are those of flag_complex.
+		 */
+		flag_filtration_generator(const std::vector<weighted_edge<T> > & edges, const std::size_t vertex_count, const std::size_t max_dimension,
+				const std::vector<T> & vertex_deletion_times = std::vector<T>()) :
+			_vertex_count(vertex_count), _max_dimension(max_dimension), _edges(edges), _adjacency(vertex_count),
+					_vertex_deletion_times(vertex_deletion_times), _next_vertex(0), _next_edge(0)
+		{
+			std::sort(this->_edges.begin(), this->_edges.end());
+
+			for (std::size_t r = 0; r < this->_edges.size(); r++)
+			{
+				this->_adjacency[this->_edges[r].i].push_back(std::make_pair(this->_edges[r].j, r));
+				this->_adjacency[this->_edges[r].j].push_back(std::make_pair(this->_edges[r].i, r));
+			}
+
+			std::size_t max_degree(1);
+			for (std::size_t v = 0; v < vertex_count; v++)
+			{
+				std::sort(this->_adjacency[v].begin(), this->_adjacency[v].end());
+				max_degree = std::max(max_degree, this->_adjacency[v].size());
+			}
+
+			this->_scratch.resize(max_dimension + 1, std::vector<std::size_t>(max_degree));
+			this->_earlier_neighbors.resize(max_degree);
+			this->_other_earlier_neighbors.resize(max_degree);
+		}
+
+		virtual ~flag_filtration_generator()
+		{
+		}
+
+		/*
+		 * Replaces the contents of batch by the next simplices of the filtration,
+		 * at most batch_size of them but at least one. Returns false once the
+		 * filtration is exhausted.
+		 */
+		bool next_batch(simplex_buffer & batch, const std::size_t batch_size)
+		{
+			batch.clear();
+			const std::size_t limit = (batch_size > 0 ? batch_size : 1);
+
+			for (; this->_next_vertex < this->_vertex_count && batch.size() < limit; this->_next_vertex++)
+			{
+				batch.push_back(std::make_pair(T(0), simplex<std::size_t>::make_simplex(this->_next_vertex)));
+			}
+
+			while (batch.size() < limit)
+			{
+				if (!this->_frames.empty())
+				{
+					this->add_next_coface(batch);
+				}
+				else if (this->_next_edge < this->_edges.size())
+				{
+					this->add_edge(this->_next_edge++, batch);
+				}
+				else
+				{
+					break;
+				}
+			}
+
+			return !batch.empty();
+		}
+
+	private:
+		/*
+		 * Adds the edge, and starts the search through its cliques.
+		 */
+		void add_edge(const std::size_t rank, simplex_buffer & batch)
+		{
+			const weighted_edge<T> & edge = this->_edges[rank];
+			const simplex<std::size_t> tau = simplex<std::size_t>::make_simplex(edge.i, edge.j);
+
+			batch.push_back(std::make_pair(edge.weight, tau));
+
+			if (this->_max_dimension < 2)
+			{
+				return;
+			}
+
+			std::size_t i_size = this->get_earlier_neighbors(edge.i, rank, this->_vertex_count, &this->_earlier_neighbors[0]);
+			std::size_t j_size = this->get_earlier_neighbors(edge.j, rank, this->_vertex_count, &this->_other_earlier_neighbors[0]);
+
+			std::size_t * N = &this->_scratch[1][0];
+			std::size_t N_size = sorted_intersection::intersect(&this->_earlier_neighbors[0], i_size, &this->_other_earlier_neighbors[0], j_size, N);
+
+			if (N_size > 0)
+			{
+				this->_frames.push_back(coface_frame(tau, N_size));
+			}
+		}
+
+		/*
+		 * Takes one step of the search: adds the next coface of the top frame,
+		 * if it is not deleted, and pushes the frame of its own cofaces. The
+		 * candidates of a coface tau + v are the earlier candidates of tau which
+		 * are joined to v by an earlier edge.
+		 */
+		void add_next_coface(simplex_buffer & batch)
+		{
+			coface_frame & frame = this->_frames.back();
+			if (frame.index == frame.size)
+			{
+				this->_frames.pop_back();
+				return;
+			}
+
+			const std::size_t rank = this->_next_edge - 1;
+			const T filtration_value = this->_edges[rank].weight;
+			const std::size_t * N = &this->_scratch[frame.tau.dimension()][0];
+			const std::size_t index = frame.index++;
+			const std::size_t v = N[index];
+
+			if (!this->_vertex_deletion_times.empty() && filtration_value > this->_vertex_deletion_times[v])
+			{
+				return;
+			}
+
+			const simplex<std::size_t> sigma = frame.tau.append_to(v);
+			batch.push_back(std::make_pair(filtration_value, sigma));
+
+			if (sigma.dimension() >= this->_max_dimension || index == 0)
+			{
+				return;
+			}
+
+			std::size_t v_size = this->get_earlier_neighbors(v, rank, v, &this->_earlier_neighbors[0]);
+			std::size_t * M = &this->_scratch[sigma.dimension()][0];
+			std::size_t M_size = sorted_intersection::intersect(N, index, &this->_earlier_neighbors[0], v_size, M);
+
+			if (M_size > 0)
+			{
+				// frame is not used past this point, since the push may move it
+				this->_frames.push_back(coface_frame(sigma, M_size));
+			}
+		}
+
+		/*
+		 * Writes the neighbors of v below the given bound, which are joined to v by
+		 * an edge of rank smaller than the given rank.
+		 */
+		std::size_t get_earlier_neighbors(const std::size_t v, const std::size_t rank, const std::size_t bound, std::size_t * result) const
+		{
+			const ranked_adjacency & adjacency = this->_adjacency[v];
+			std::size_t size(0);
+
+			for (std::size_t k = 0; k < adjacency.size() && adjacency[k].first < bound; k++)
+			{
+				if (adjacency[k].second < rank)
+				{
+					result[size++] = adjacency[k].first;
+				}
+			}
+
+			return size;
+		}
+	};
+
+}
+
+#endif /* FLAG_FILTRATION_GENERATOR_H_ */
@@ -0,0 +1,276 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef KD_TREE_H_
+#define KD_TREE_H_
+
+#include <vector>
+#include <algorithm>
+
+#include "spatial_index.h"
+#include "basic_matrix.h"
+#include "metrics.h"
+#include "parallel_utility.h"
+
+namespace cph
+{
+
+	/*
+	 * k-d tree over the rows of a point matrix, for the metrics induced by a
+	 * norm which is monotone in the absolute coordinate differences (euclidean,
+	 * maximum and manhattan). Every node keeps the bounding box of its points,
+	 * and a subtree is skipped when the distance from the query point to its box
+	 * exceeds the radius.
+	 *
+	 * The nodes are split at the median of the coordinate of largest spread, and
+	 * the subtrees of large nodes are built in parallel as OpenMP tasks.
+	 */
+	template<class T>
+	class kd_tree: public spatial_index<T>
+	{
+	private:
+		static const std::size_t LEAF_SIZE = 16;
+		static const std::size_t PARALLEL_CUTOFF = 4096;
+
+		struct node
+		{
+			std::size_t begin, end;
+			std::vector<T> lower, upper;
+			node * left;
+			node * right;
+
+			node(const std::size_t b, const std::size_t e) :
+				begin(b), end(e), left(0), right(0)
+			{
+			}
+
+			~node()
+			{
+				delete (left);
+				delete (right);
+			}
+		};
+
+		struct coordinate_comparison
+		{
+			const basic_matrix<T> & points;
+			const std::size_t coordinate;
+
+			coordinate_comparison(const basic_matrix<T> & p, const std::size_t c) :
+				points(p), coordinate(c)
+			{
+			}
+
+			bool operator()(const std::size_t a, const std::size_t b) const
+			{
+				return (this->points(a, this->coordinate) < this->points(b, this->coordinate));
+			}
+		};
+
+		const basic_matrix<T> & _points;
+		const metric _metric_type;
+		std::vector<std::size_t> _permutation;
+		node * _root;
+
+	public:
+		kd_tree(const finite_metric_space<T> & metric_space, const basic_matrix<T> & points, const metric metric_type) :
+			spatial_index<T> (metric_space), _points(points), _metric_type(metric_type), _permutation(points.rows()), _root(0)
+		{
+			for (std::size_t i = 0; i < this->_permutation.size(); i++)
+			{
+				this->_permutation[i] = i;
+			}
+
+			CPH_OMP(parallel)
+			{
+				CPH_OMP(single)
+				this->_root = this->build(0, this->_permutation.size());
+			}
+		}
+
+		virtual ~kd_tree()
+		{
+			delete (this->_root);
+		}
+
+		static bool supports(const metric metric_type)
+		{
+			return (metric_type == euclidean || metric_type == maximum || metric_type == manhattan);
+		}
+
+		void radius_query(const std::size_t i, const T radius, typename spatial_index<T>::neighbor_list & result, const std::size_t first_point = 0) const
+		{
+			this->radius_query(this->_root, i, radius, radius + spatial_index<T>::slack(radius), result, first_point);
+		}
+
+		void nearest_neighbors(const std::size_t i, const std::size_t k, typename spatial_index<T>::neighbor_list & result) const
+		{
+			typename spatial_index<T>::candidate_heap candidates;
+			if (k > 0)
+			{
+				this->nearest_neighbors(this->_root, i, k, candidates);
+			}
+			spatial_index<T>::drain(candidates, result);
+		}
+
+	private:
+		node * build(const std::size_t begin, const std::size_t end)
+		{
+			node * result = new node(begin, end);
+			const std::size_t d = this->_points.columns();
+
+			result->lower.assign(d, T(0));
+			result->upper.assign(d, T(0));
+			for (std::size_t c = 0; c < d; c++)
+			{
+				result->lower[c] = result->upper[c] = this->_points(this->_permutation[begin], c);
+				for (std::size_t k = begin + 1; k < end; k++)
+				{
+					const T x = this->_points(this->_permutation[k], c);
+					result->lower[c] = std::min(result->lower[c], x);
+					result->upper[c] = std::max(result->upper[c], x);
+				}
+			}
+
+			if (end - begin <= LEAF_SIZE)
+			{
+				return result;
+			}
+
+			std::size_t split(0);
+			for (std::size_t c = 1; c < d; c++)
+			{
+				if (result->upper[c] - result->lower[c] > result->upper[split] - result->lower[split])
+				{
+					split = c;
+				}
+			}
+
+			// all points coincide
+			if (d == 0 || !(result->upper[split] > result->lower[split]))
+			{
+				return result;
+			}
+
+			const std::size_t middle = begin + (end - begin) / 2;
+			std::nth_element(this->_permutation.begin() + begin, this->_permutation.begin() + middle, this->_permutation.begin() + end,
+					coordinate_comparison(this->_points, split));
+
+			CPH_OMP(task if (end - begin > PARALLEL_CUTOFF))
+			result->left = this->build(begin, middle);
+
+			result->right = this->build(middle, end);
+
+			CPH_OMP(taskwait)
+
+			return result;
+		}
+
+		void radius_query(const node * current, const std::size_t i, const T radius, const T bound, typename spatial_index<T>::neighbor_list & result,
+				const std::size_t first_point) const
+		{
+			if (this->box_distance(current, i) > bound)
+			{
+				return;
+			}
+
+			if (current->left == 0)
+			{
+				for (std::size_t k = current->begin; k < current->end; k++)
+				{
+					const std::size_t j = this->_permutation[k];
+					if (j >= first_point && j != i)
+					{
+						const T distance = this->ordered_distance(i, j);
+						if (distance <= radius)
+						{
+							result.push_back(std::make_pair(j, distance));
+						}
+					}
+				}
+				return;
+			}
+
+			this->radius_query(current->left, i, radius, bound, result, first_point);
+			this->radius_query(current->right, i, radius, bound, result, first_point);
+		}
+
+		/*
+		 * Visits the child whose box is closer to the query point first, so that
+		 * the bound shrinks before the other child is considered.
+		 */
+		void nearest_neighbors(const node * current, const std::size_t i, const std::size_t k, typename spatial_index<T>::candidate_heap & candidates) const
+		{
+			const T bound = spatial_index<T>::candidate_bound(candidates, k);
+			if (this->box_distance(current, i) > bound + spatial_index<T>::slack(bound))
+			{
+				return;
+			}
+
+			if (current->left == 0)
+			{
+				for (std::size_t r = current->begin; r < current->end; r++)
+				{
+					const std::size_t j = this->_permutation[r];
+					if (j != i)
+					{
+						spatial_index<T>::offer(candidates, k, this->ordered_distance(i, j), j);
+					}
+				}
+				return;
+			}
+
+			const bool left_first = (this->box_distance(current->left, i) <= this->box_distance(current->right, i));
+			this->nearest_neighbors(left_first ? current->left : current->right, i, k, candidates);
+			this->nearest_neighbors(left_first ? current->right : current->left, i, k, candidates);
+		}
+
+		/*
+		 * A lower bound for the distance from point i to the box of the node.
+		 * The distance kernels may sum the coordinates in another order, and the
+		 * slack added to the pruning bounds covers the rounding differences.
+		 */
+		T box_distance(const node * current, const std::size_t i) const
+		{
+			T result(0);
+
+			for (std::size_t c = 0; c < this->_points.columns(); c++)
+			{
+				const T x = this->_points(i, c);
+				T gap(0);
+
+				if (x < current->lower[c])
+				{
+					gap = current->lower[c] - x;
+				}
+				else if (x > current->upper[c])
+				{
+					gap = x - current->upper[c];
+				}
+
+				switch (this->_metric_type)
+				{
+					case maximum:
+						result = std::max(result, gap);
+						break;
+					case manhattan:
+						result += gap;
+						break;
+					default:
+						result += gap * gap;
+						break;
+				}
+			}
+
+			return (this->_metric_type == euclidean ? std::sqrt(result) : result);
+		}
+	};
+
+}
+
+#endif /* KD_TREE_H_ */
@@ -10,8 +10,13 @@
 #define LANDMARK_SELECTOR_HPP_
 
 #include "random_utility.h"
+#include "finite_metric_space.h"
+#include "pairwise_distances.h"
+#include "cover_tree.h"
+#include "parallel_utility.h"
 
 #include <vector>
+#include <limits>
 #include <algorithm>
 
 namespace cph
@@ -20,6 +25,13 @@ namespace cph
 	class landmark_selector
 	{
 	public:
+		/*
+		 * The largest distance rows, in bytes, which callers of the maxmin
+		 * selection should keep; beyond this the distances are recomputed as
+		 * they are needed.
+		 */
+		static const std::size_t MAX_KEPT_DISTANCE_BYTES = 16 * 1024 * 1024;
+
 		landmark_selector()
 		{
 		}
@@ -44,6 +56,28 @@ namespace cph
 
 		template<class T>
 		static std::vector<std::size_t> maxmin_landmark_selection(const finite_metric_space<T> & metric_space, const std::size_t selection_size)
+		{
+			return landmark_selector::select_maxmin(metric_space, selection_size, static_cast<std::vector<T> *> (0));
+		}
+
+		/*
+		 * As above, and keeps the distances from the landmarks to all the points,
+		 * which the selection computes anyway, in landmark_distances: the
+		 * distance from landmark i to point z is landmark_distances[i n + z].
+		 * They can be handed to lazy_witness_complex. These selection_size n
+		 * distances are only worth keeping while they fit in
+		 * MAX_KEPT_DISTANCE_BYTES.
+		 */
+		template<class T>
+		static std::vector<std::size_t> maxmin_landmark_selection(const finite_metric_space<T> & metric_space, const std::size_t selection_size,
+				std::vector<T> & landmark_distances)
+		{
+			return landmark_selector::select_maxmin(metric_space, selection_size, &landmark_distances);
+		}
+
+		template<class T>
+		static std::vector<std::size_t> approx_maxmin_landmark_selection(const finite_metric_space<T> & metric_space, const std::size_t selection_size,
+				const std::size_t sample_size = 100)
 		{
 			std::size_t initial_point = random_utility::random_integer(0, metric_space.size() - 1);
 
@@ -51,6 +85,8 @@ namespace cph
 
 			indices.push_back(initial_point);
 
+			const std::size_t filtered_sample_size(sample_size < metric_space.size() ? sample_size : metric_space.size());
+
 			/*
 			 * Construct the landmark set inductively. Suppose that
 			 * {l_0, ..., l_{i-1}} have been chosen as landmark points.
@@ -65,8 +101,9 @@ namespace cph
 				T f_value = T(0);
 				T max_f_value = T(0);
 				std::size_t arg_max(0);
-				for (std::size_t z = 0; z < metric_space.size(); z++)
+				for (std::size_t z_index = 0; z_index < filtered_sample_size; z_index++)
 				{
+					std::size_t z = random_utility::random_integer(0, metric_space.size() - 1);
 					f_value = landmark_selector::compute_min_distance(metric_space, indices, z);
 					if (f_value > max_f_value)
 					{
@@ -81,18 +118,146 @@ namespace cph
 			return indices;
 		}
 
+		/*
+		 * Selects an epsilon-net: landmarks more than epsilon apart from each
+		 * other, with every point within epsilon of a landmark. The points are
+		 * scanned in order, and a point becomes a landmark unless a landmark
+		 * already covers it, which a cover tree over the landmarks answers in
+		 * O(log n) distances for metrics of bounded expansion.
+		 *
+		 * Any set of balls of radius epsilon / 2 covering the points has at least
+		 * as many balls as the net has landmarks, since no such ball holds two of
+		 * them.
+		 */
 		template<class T>
-		static std::vector<std::size_t> approx_maxmin_landmark_selection(const finite_metric_space<T> & metric_space, const std::size_t selection_size,
-				const std::size_t sample_size = 100)
+		static std::vector<std::size_t> epsilon_net_landmark_selection(const finite_metric_space<T> & metric_space, const T epsilon)
 		{
-			std::size_t initial_point = random_utility::random_integer(0, metric_space.size() - 1);
+			std::vector<std::size_t> indices;
+			if (metric_space.size() == 0)
+			{
+				return indices;
+			}
+
+			cover_tree<T> landmarks(metric_space, 0);
+			indices.push_back(0);
+
+			for (std::size_t z = 1; z < metric_space.size(); z++)
+			{
+				if (!landmarks.covers(z, epsilon))
+				{
+					landmarks.insert(z);
+					indices.push_back(z);
+				}
+			}
+
+			return indices;
+		}
+
+		/*
+		 * Orders all the points of the metric space greedily, starting from
+		 * initial_point: each next point is the one furthest from the points
+		 * before it, ties going to the smallest index. The distance of each point
+		 * to the points before it (its insertion radius, infinite for the first
+		 * point) is written to insertion_radii, indexed by position in the order.
+		 *
+		 * The distances to the already ordered points are maintained incrementally,
+		 * so this takes n^2 distance computations; the distances from each new
+		 * point, the update and the search for the furthest point are run in
+		 * parallel.
+		 */
+		template<class T>
+		static std::vector<std::size_t> greedy_permutation(const finite_metric_space<T> & metric_space, std::vector<T> & insertion_radii,
+				const std::size_t initial_point = 0)
+		{
+			const std::size_t n = metric_space.size();
+
+			std::vector<std::size_t> order;
+			std::vector<T> min_distances(n, std::numeric_limits<T>::max());
+			std::vector<bool> ordered(n, false);
+			std::vector<T> distances(n);
+
+			insertion_radii.clear();
+
+			if (n == 0)
+			{
+				return order;
+			}
+
+			std::size_t next = initial_point;
+			T next_radius = (std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max());
+
+			while (true)
+			{
+				order.push_back(next);
+				insertion_radii.push_back(next_radius);
+				ordered[next] = true;
+
+				if (order.size() == n)
+				{
+					break;
+				}
+
+				pairwise_distances::distance_row(metric_space, next, distances);
+
+				T max_distance(-1);
+
+				CPH_OMP(parallel)
+				{
+					T thread_max_distance(-1);
+					std::size_t thread_next(0);
+
+					CPH_OMP(for nowait)
+					for (std::size_t z = 0; z < n; z++)
+					{
+						if (ordered[z])
+						{
+							continue;
+						}
+
+						if (distances[z] < min_distances[z])
+						{
+							min_distances[z] = distances[z];
+						}
+
+						if (min_distances[z] > thread_max_distance)
+						{
+							thread_max_distance = min_distances[z];
+							thread_next = z;
+						}
+					}
+
+					CPH_OMP(critical)
+					{
+						if (thread_max_distance > max_distance || (thread_max_distance == max_distance && thread_next < next))
+						{
+							max_distance = thread_max_distance;
+							next = thread_next;
+						}
+					}
+				}
+
+				next_radius = max_distance;
+			}
+
+			return order;
+		}
+
+	private:
+		/*
+		 * The maxmin selection, keeping the distance rows of the landmarks when
+		 * landmark_distances is not null.
+		 */
+		template<class T>
+		static std::vector<std::size_t> select_maxmin(const finite_metric_space<T> & metric_space, const std::size_t selection_size,
+				std::vector<T> * landmark_distances)
+		{
+			const std::size_t n = metric_space.size();
+			std::size_t initial_point = random_utility::random_integer(0, n - 1);
 
 			std::vector<std::size_t> indices;
 
 			indices.push_back(initial_point);
 
-			const std::size_t filtered_sample_size(sample_size < metric_space.size() ? sample_size : metric_space.size());
-
 			/*
 			 * Construct the landmark set inductively. Suppose that
 			 * {l_0, ..., l_{i-1}} have been chosen as landmark points.
@@ -100,31 +265,91 @@ namespace cph
 			 * f(z) = min{d(z, l_0), ...., d(z, l_{i-1}}
 			 * and define l_i to be l_i = arg max f(z)
 			 *
+			 * f is kept for all the points and lowered with the distances from
+			 * each new landmark only, so that L N distances are computed in
+			 * all. Ties go to the smallest index, and to point 0 if f vanishes.
 			 */
+			std::vector<T> f_values(n, std::numeric_limits<T>::max());
+			std::vector<T> distances(n);
+
+			if (landmark_distances != 0)
+			{
+				landmark_distances->clear();
+				landmark_distances->reserve((selection_size > 1 ? selection_size : 1) * n);
+			}
+
 			while (indices.size() < selection_size)
 			{
+				const T * row = landmark_selector::next_distance_row(metric_space, indices, distances, landmark_distances);
+
 				// find point that maximizes the minimum distance to the existing landmark points
-				T f_value = T(0);
 				T max_f_value = T(0);
 				std::size_t arg_max(0);
-				for (std::size_t z_index = 0; z_index < filtered_sample_size; z_index++)
+
+				CPH_OMP(parallel)
 				{
-					std::size_t z = random_utility::random_integer(0, metric_space.size() - 1);
-					f_value = landmark_selector::compute_min_distance(metric_space, indices, z);
-					if (f_value > max_f_value)
+					T thread_max_f_value = T(0);
+					std::size_t thread_arg_max(0);
+
+					CPH_OMP(for schedule(static) nowait)
+					for (std::size_t z = 0; z < n; z++)
 					{
-						arg_max = z;
-						max_f_value = f_value;
+						if (row[z] < f_values[z])
+						{
+							f_values[z] = row[z];
+						}
+
+						if (f_values[z] > thread_max_f_value)
+						{
+							thread_arg_max = z;
+							thread_max_f_value = f_values[z];
+						}
+					}
+
+					CPH_OMP(critical)
+					{
+						if (thread_max_f_value > max_f_value || (thread_max_f_value == max_f_value && thread_arg_max < arg_max))
+						{
+							arg_max = thread_arg_max;
+							max_f_value = thread_max_f_value;
+						}
 					}
 				}
 
 				indices.push_back(arg_max);
 			}
 
+			// the row of the last landmark is only needed by the caller
+			if (landmark_distances != 0)
+			{
+				landmark_selector::next_distance_row(metric_space, indices, distances, landmark_distances);
+			}
+
 			return indices;
 		}
 
-	private:
+		/*
+		 * Computes the distances from the last landmark to all the points,
+		 * appended to landmark_distances if it is not null, and in distances
+		 * otherwise.
+		 */
+		template<class T>
+		static const T * next_distance_row(const finite_metric_space<T> & metric_space, const std::vector<std::size_t> & indices,
+				std::vector<T> & distances, std::vector<T> * landmark_distances)
+		{
+			const std::size_t n = metric_space.size();
+			if (landmark_distances == 0 || n == 0)
+			{
+				pairwise_distances::distance_row(metric_space, indices.back(), distances);
+				return (n == 0 ? 0 : &distances[0]);
+			}
+
+			landmark_distances->resize(indices.size() * n);
+			T * row = &(*landmark_distances)[(indices.size() - 1) * n];
+			pairwise_distances::distance_row(metric_space, indices.back(), row);
+			return row;
+		}
+
 		template<class T>
 		static inline T compute_min_distance(const finite_metric_space<T> & metric_space, const std::vector<std::size_t> & landmark_set,
 				const std::size_t query_point)
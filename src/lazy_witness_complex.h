@@ -11,10 +11,14 @@
 
 #include <vector>
 #include <algorithm>
+#include <limits>
 
 #include "flag_complex.h"
-#include "basic_graph.h"
+#include "weighted_edge.h"
 #include "basic_matrix.h"
+#include "finite_metric_space.h"
+#include "pairwise_distances.h"
+#include "parallel_utility.h"
 
 namespace cph
 {
@@ -25,13 +29,21 @@ class lazy_witness_complex: public flag_complex<T>
 protected:
 	const std::vector<std::size_t> & _landmark_selection;
 	const std::size_t _nu;
+	const T * const _landmark_distances;
 public:
+	/*
+	 * If landmark_distances is given, it holds the distances from each landmark
+	 * to all the points, one landmark after the other, as kept by
+	 * landmark_selector::maxmin_landmark_selection, and no distance is computed.
+	 */
 	lazy_witness_complex(const finite_metric_space<T> & metric_space,
 			const std::vector<std::size_t> & landmark_selection,
 			const T & max_filtration_value,
-			const int max_dimension) :
-			flag_complex<T>(metric_space, max_filtration_value, max_dimension, landmark_selection.size()),
-			_landmark_selection(landmark_selection), _nu(2)
+			const int max_dimension,
+			const bool collapse_edges = false,
+			const T * landmark_distances = 0) :
+			flag_complex<T>(metric_space, max_filtration_value, max_dimension, landmark_selection.size(), collapse_edges),
+			_landmark_selection(landmark_selection), _nu(2), _landmark_distances(landmark_distances)
 	{
 	}
 
@@ -39,15 +51,15 @@ public:
 	{
 	}
 
-	virtual basic_graph<T> * create_1_skeleton()
+	virtual std::vector<weighted_edge<T> > create_1_skeleton()
 	{
-		std::size_t N = this->_metric_space.size();
+		std::size_t N = this->_metric_space->size();
 		std::size_t L = this->_landmark_selection.size();
 
-		basic_graph<T> * graph(new basic_graph<T>());
+		std::vector<weighted_edge<T> > edges;
 
 		/*
-		 * Let N be the number of points in the metric space, and n the number of
+		 * Let N be the number of points in the metric space, and L the number of
 		 * landmark points. Let D be the L x N matrix of distances between the set
 		 * of landmark points, and the set of all points in the metric space.
 		 *
@@ -58,77 +70,306 @@ public:
 		 * - The edge [ab] belongs to W(D, R, nu) iff there exists as witness i in {1, ..., N} such
 		 * that max(D(a, i), D(b, i)) <= R + m_i
 		 *
+		 * The weight of [ab] is thus e_ab = min_i max(max(D(a, i), D(b, i)) - m_i, 0).
+		 *
+		 * Witness i only matters for the landmarks a with D(a, i) < R + m_i. When
+		 * these are few, only the pairs among them are updated, which is
+		 * O(N k^2) work for k such landmarks per witness instead of O(N L^2).
 		 */
 
-		std::vector<double> m(N);
-		std::vector<std::size_t> m_temp;
+		basic_matrix<T> E(L, L, std::numeric_limits<T>::max());
 
-		basic_matrix<double> D(L, N);
+		// the witnesses are streamed in blocks: the distances from a block to the
+		// landmarks are computed, folded into E and discarded, so that only
+		// O(L^2 + WITNESS_BLOCK L) distances are held at any time
+		std::vector<T> tile(L * WITNESS_BLOCK), W(WITNESS_BLOCK * L), m(WITNESS_BLOCK);
+		candidate_lists candidates;
 
-		for (std::size_t l = 0; l < L; l++)
+		for (std::size_t begin = 0; begin < N; begin += WITNESS_BLOCK)
 		{
-			std::size_t landmark_point = this->_landmark_selection[l];
-			for (std::size_t n = 0; n < N; n++)
+			const std::size_t block_size = (begin + WITNESS_BLOCK < N ? WITNESS_BLOCK : N - begin);
+
+			this->compute_distances(begin, block_size, tile, W);
+			this->compute_m(W, block_size, L, m);
+
+			if (this->select_candidates(W, block_size, L, m, candidates))
+			{
+				this->fold_candidates(W, L, m, candidates, E);
+			}
+			else
+			{
+				this->fold_witnesses(W, block_size, L, m, E);
+			}
+		}
+
+		for (std::size_t i = 0; i < L; i++)
+		{
+			for (std::size_t j = i + 1; j < L; j++)
 			{
-				D(l, n) = this->_metric_space.distance(landmark_point, n);
+				const T e_ij = (N > 0 ? E(i, j) : T(0));
+				if (e_ij < this->_max_filtration_value)
+				{
+					edges.push_back(weighted_edge<T>(i, j, e_ij));
+				}
 			}
 		}
 
-		if (this->_nu > 0)
+		return edges;
+	}
+
+protected:
+	static const std::size_t LANDMARK_BLOCK = 32;
+	static const std::size_t WITNESS_BLOCK = 256;
+
+	// the sparse update is used when it visits this many times fewer pairs
+	// than the dense one, which is vectorized
+	static const std::size_t SPARSE_ADVANTAGE = 4;
+
+	/*
+	 * The landmarks which witness n can join by an edge of weight below the
+	 * maximum filtration value are landmarks[offsets[n]], ...,
+	 * landmarks[offsets[n + 1] - 1], in increasing order. The witnesses of
+	 * landmark a are given the same way, each with the position of a in its
+	 * list.
+	 */
+	struct candidate_lists
+	{
+		std::vector<std::size_t> offsets, landmarks;
+		std::vector<std::size_t> witness_offsets;
+		std::vector<std::pair<std::size_t, std::size_t> > witnesses;
+	};
+
+	/*
+	 * Fills W with the distances from the witnesses begin, ..., begin +
+	 * block_size - 1 to the landmarks, one witness per row. They are computed
+	 * as the block of D, distance(landmark, witness), by groups of landmarks in
+	 * parallel, and then transposed, or copied from the given distances. The
+	 * blocks come from finite_metric_space::approximate_distances, so that the
+	 * distances of a high dimensional euclidean point cloud are computed with
+	 * a matrix multiplication.
+	 */
+	void compute_distances(const std::size_t begin, const std::size_t block_size, std::vector<T> & tile, std::vector<T> & W) const
+	{
+		const std::size_t L = this->_landmark_selection.size();
+
+		if (this->_landmark_distances != 0)
 		{
-			//T m_temp[L + 1];
+			const std::size_t N = this->_metric_space->size();
 
-			for (std::size_t n = 0; n < N; n++)
+			CPH_OMP(parallel for schedule(static))
+			for (std::size_t n = 0; n < block_size; n++)
 			{
-				m_temp.clear();
-				m_temp.push_back(0);
 				for (std::size_t l = 0; l < L; l++)
 				{
-					m_temp.push_back(D(l, n));
+					W[n * L + l] = this->_landmark_distances[l * N + begin + n];
 				}
-				std::sort(m_temp.begin(), m_temp.end());
-				m[n] = m_temp[this->_nu];
 			}
+			return;
+		}
+		const std::size_t row_blocks = (L + pairwise_distances::ROW_BLOCK - 1) / pairwise_distances::ROW_BLOCK;
+
+		CPH_OMP(parallel for schedule(static))
+		for (std::size_t block = 0; block < row_blocks; block++)
+		{
+			const std::size_t row_begin = block * pairwise_distances::ROW_BLOCK;
+			const std::size_t row_count = (row_begin + pairwise_distances::ROW_BLOCK < L ? pairwise_distances::ROW_BLOCK : L - row_begin);
+			this->_metric_space->approximate_distances(&this->_landmark_selection[row_begin], row_count, begin, begin + block_size,
+					&tile[row_begin * block_size]);
+		}
+
+		CPH_OMP(parallel for schedule(static))
+		for (std::size_t n = 0; n < block_size; n++)
+		{
+			for (std::size_t l = 0; l < L; l++)
+			{
+				W[n * L + l] = tile[l * block_size + n];
+			}
+		}
+	}
 
+	/*
+	 * Sets m[n] to the nu-th smallest distance from witness n to the
+	 * landmarks, i.e. the nu-th smallest entry of row n of W, found by partial
+	 * selection.
+	 */
+	void compute_m(const std::vector<T> & W, const std::size_t block_size, const std::size_t L, std::vector<T> & m) const
+	{
+		if (this->_nu == 0 || L == 0)
+		{
+			std::fill(m.begin(), m.end(), T(0));
+			return;
 		}
 
-		T e_ij(0), d_ij(0);
-		T d_in(0), d_jn(0);
+		const std::size_t rank = (this->_nu < L ? this->_nu : L) - 1;
 
-		for (std::size_t i = 0; i < L; i++)
+		CPH_OMP(parallel)
 		{
-			for (std::size_t j = i + 1; j < L; j++)
+			std::vector<T> distances(L);
+
+			CPH_OMP(for schedule(static))
+			for (std::size_t n = 0; n < block_size; n++)
 			{
-				e_ij = 0;
-				for (std::size_t n = 0; n < N; n++)
-				{
-					d_in = D(i, n);
-					d_jn = D(j, n);
-					d_ij = (d_in > d_jn ? d_in: d_jn);
-					if (d_ij < m[n])
-					{
-						d_ij = 0;
-					}
-					else
-					{
-						d_ij -= m[n];
-					}
+				std::copy(W.begin() + n * L, W.begin() + (n + 1) * L, distances.begin());
+				std::nth_element(distances.begin(), distances.begin() + rank, distances.end());
+				m[n] = distances[rank];
+			}
+		}
+	}
 
-					if (n == 0 || (d_ij < e_ij))
-					{
-						e_ij = d_ij;
-					}
+	/*
+	 * A witness n only gives an edge [ab] a weight below the maximum
+	 * filtration value R if D(a, n) - m[n] < R and D(b, n) - m[n] < R. These
+	 * landmarks are listed for each witness of the block, and the lists are
+	 * kept if the pairs they contain are few enough for fold_candidates to
+	 * beat fold_witnesses. Both give the same weights below R.
+	 */
+	bool select_candidates(const std::vector<T> & W, const std::size_t block_size, const std::size_t L, const std::vector<T> & m,
+			candidate_lists & candidates) const
+	{
+		const T R = this->_max_filtration_value;
+		std::vector<std::size_t> & offsets = candidates.offsets;
+
+		offsets.assign(block_size + 1, 0);
+
+		CPH_OMP(parallel for schedule(static))
+		for (std::size_t n = 0; n < block_size; n++)
+		{
+			std::size_t count(0);
+			for (std::size_t l = 0; l < L; l++)
+			{
+				count += (W[n * L + l] - m[n] < R ? 1 : 0);
+			}
+			offsets[n + 1] = count;
+		}
+
+		double pairs(0);
+		for (std::size_t n = 0; n < block_size; n++)
+		{
+			pairs += 0.5 * double(offsets[n + 1]) * double(offsets[n + 1]);
+			offsets[n + 1] += offsets[n];
+		}
+
+		if (pairs * SPARSE_ADVANTAGE >= 0.5 * double(block_size) * double(L) * double(L))
+		{
+			return false;
+		}
+
+		candidates.landmarks.resize(offsets[block_size]);
+
+		CPH_OMP(parallel for schedule(static))
+		for (std::size_t n = 0; n < block_size; n++)
+		{
+			std::size_t k = offsets[n];
+			for (std::size_t l = 0; l < L; l++)
+			{
+				if (W[n * L + l] - m[n] < R)
+				{
+					candidates.landmarks[k++] = l;
 				}
+			}
+		}
 
-				if (e_ij < this->_max_filtration_value)
+		std::vector<std::size_t> & witness_offsets = candidates.witness_offsets;
+		witness_offsets.assign(L + 1, 0);
+		for (std::size_t k = 0; k < candidates.landmarks.size(); k++)
+		{
+			witness_offsets[candidates.landmarks[k] + 1]++;
+		}
+		for (std::size_t l = 0; l < L; l++)
+		{
+			witness_offsets[l + 1] += witness_offsets[l];
+		}
+
+		std::vector<std::size_t> next(witness_offsets.begin(), witness_offsets.end() - 1);
+		candidates.witnesses.resize(candidates.landmarks.size());
+		for (std::size_t n = 0; n < block_size; n++)
+		{
+			for (std::size_t k = offsets[n]; k < offsets[n + 1]; k++)
+			{
+				candidates.witnesses[next[candidates.landmarks[k]]++] = std::make_pair(n, k);
+			}
+		}
+
+		return true;
+	}
+
+	/*
+	 * Lowers E(a, b), a < b, over the witnesses of the block and the pairs of
+	 * their candidate landmarks. The rows of E are processed in parallel; row a
+	 * is updated from the witnesses of a, and the candidates after a in their
+	 * lists.
+	 */
+	void fold_candidates(const std::vector<T> & W, const std::size_t L, const std::vector<T> & m, const candidate_lists & candidates,
+			basic_matrix<T> & E) const
+	{
+		CPH_OMP(parallel for schedule(dynamic, 8))
+		for (std::size_t a = 0; a < L; a++)
+		{
+			T * E_a = &E(a, 0);
+			for (std::size_t w = candidates.witness_offsets[a]; w < candidates.witness_offsets[a + 1]; w++)
+			{
+				const std::size_t n = candidates.witnesses[w].first;
+				const T * W_n = &W[n * L];
+				const T d_a = W_n[a];
+
+				for (std::size_t k = candidates.witnesses[w].second + 1; k < candidates.offsets[n + 1]; k++)
 				{
-					graph->add_edge(i, j, e_ij);
+					const std::size_t b = candidates.landmarks[k];
+					T d = (d_a > W_n[b] ? d_a : W_n[b]) - m[n];
+					d = (d > 0 ? d : T(0));
+					E_a[b] = (d < E_a[b] ? d : E_a[b]);
 				}
 			}
 		}
+	}
 
+	/*
+	 * Lowers E(i, j), i < j, to the smallest max(max(W(n, i), W(n, j)) - m[n], 0)
+	 * over the witnesses n of the block.
+	 *
+	 * The landmark pairs are split into tiles of LANDMARK_BLOCK x
+	 * LANDMARK_BLOCK, which write to disjoint entries of E and are processed in
+	 * parallel. Within a tile, the innermost loop runs over contiguous entries
+	 * of a row of E and of a row of W, and has no dependencies between its
+	 * iterations, so it is marked for vectorization.
+	 */
+	void fold_witnesses(const std::vector<T> & W, const std::size_t block_size, const std::size_t L, const std::vector<T> & m,
+			basic_matrix<T> & E) const
+	{
+		const std::size_t landmark_blocks = (L + LANDMARK_BLOCK - 1) / LANDMARK_BLOCK;
 
-		return graph;
+		CPH_OMP(parallel for schedule(dynamic, 1))
+		for (std::size_t t = 0; t < landmark_blocks * landmark_blocks; t++)
+		{
+			const std::size_t i_begin = (t / landmark_blocks) * LANDMARK_BLOCK;
+			const std::size_t j_begin = (t % landmark_blocks) * LANDMARK_BLOCK;
+			if (j_begin < i_begin)
+			{
+				continue;
+			}
+
+			const std::size_t i_end = (i_begin + LANDMARK_BLOCK < L ? i_begin + LANDMARK_BLOCK : L);
+			const std::size_t j_end = (j_begin + LANDMARK_BLOCK < L ? j_begin + LANDMARK_BLOCK : L);
+
+			for (std::size_t n = 0; n < block_size; n++)
+			{
+				const T * W_n = &W[n * L];
+				const T m_n = m[n];
+
+				for (std::size_t i = i_begin; i < i_end; i++)
+				{
+					const T d_i = W_n[i];
+					T * E_i = &E(i, 0);
+					CPH_OMP(simd)
+					for (std::size_t j = std::max(j_begin, i + 1); j < j_end; j++)
+					{
+						T d = (d_i > W_n[j] ? d_i : W_n[j]) - m_n;
+						d = (d > 0 ? d : T(0));
+						E_i[j] = (d < E_i[j] ? d : E_i[j]);
+					}
+				}
+			}
+		}
 	}
 };
 
@@ -0,0 +1,325 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef PAIRWISE_DISTANCES_H_
+#define PAIRWISE_DISTANCES_H_
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "finite_metric_space.h"
+#include "basic_matrix.h"
+#include "weighted_edge.h"
+#include "parallel_utility.h"
+
+namespace cph
+{
+
+	/*
+	 * Tiled, multithreaded kernels for computing many distances of a finite
+	 * metric space at once. The pairs are processed in tiles of ROW_BLOCK x
+	 * COLUMN_BLOCK, filled with one call to finite_metric_space::distances, so
+	 * that the points of a tile stay in cache and the metric is dispatched once
+	 * per tile. The tiles of different row blocks are computed in parallel.
+	 *
+	 * Every distance is computed as distance(row, column) with the same
+	 * arguments as the corresponding pairwise loop, so the results are
+	 * identical to those of the loop.
+	 */
+	class pairwise_distances
+	{
+	private:
+		pairwise_distances()
+		{
+		}
+
+	public:
+		static const std::size_t ROW_BLOCK = 64;
+		static const std::size_t COLUMN_BLOCK = 512;
+
+		virtual ~pairwise_distances()
+		{
+		}
+
+		/*
+		 * The edges [ij], i < j, with distance(i, j) <= threshold, in the order in
+		 * which a loop over i and then j would produce them. The tiles are filled
+		 * with finite_metric_space::threshold_distances, which may skip the exact
+		 * computation of the distances above threshold. With a positive
+		 * first_point, only the edges with j >= first_point are returned, and only
+		 * their distances are computed.
+		 */
+		template<class T>
+		static std::vector<weighted_edge<T> > threshold_edges(const finite_metric_space<T> & metric_space, const T threshold,
+				const std::size_t first_point = 0)
+		{
+			const std::size_t n = metric_space.size();
+			const std::size_t row_blocks = (n + ROW_BLOCK - 1) / ROW_BLOCK;
+			std::vector<std::vector<weighted_edge<T> > > row_edges(n);
+
+			CPH_OMP(parallel)
+			{
+				std::vector<T> tile(ROW_BLOCK * COLUMN_BLOCK);
+				std::vector<std::size_t> rows(ROW_BLOCK);
+
+				// the later row blocks have fewer pairs, so the blocks are handed out dynamically
+				CPH_OMP(for schedule(dynamic, 1))
+				for (std::size_t block = 0; block < row_blocks; block++)
+				{
+					const std::size_t row_begin = block * ROW_BLOCK;
+					const std::size_t row_count = std::min(row_begin + ROW_BLOCK, n) - row_begin;
+
+					for (std::size_t r = 0; r < row_count; r++)
+					{
+						rows[r] = row_begin + r;
+					}
+
+					for (std::size_t column_begin = std::max(row_begin + 1, first_point); column_begin < n; column_begin += COLUMN_BLOCK)
+					{
+						const std::size_t column_end = std::min(column_begin + COLUMN_BLOCK, n);
+						const std::size_t column_count = column_end - column_begin;
+
+						metric_space.threshold_distances(&rows[0], row_count, column_begin, column_end, threshold, &tile[0]);
+
+						for (std::size_t r = 0; r < row_count; r++)
+						{
+							const T * distances = &tile[r * column_count];
+							for (std::size_t j = std::max(column_begin, rows[r] + 1); j < column_end; j++)
+							{
+								if (distances[j - column_begin] <= threshold)
+								{
+									row_edges[rows[r]].push_back(weighted_edge<T> (rows[r], j, distances[j - column_begin]));
+								}
+							}
+						}
+					}
+				}
+			}
+
+			std::size_t edge_count(0);
+			for (std::size_t i = 0; i < n; i++)
+			{
+				edge_count += row_edges[i].size();
+			}
+
+			std::vector<weighted_edge<T> > edges;
+			edges.reserve(edge_count);
+			for (std::size_t i = 0; i < n; i++)
+			{
+				edges.insert(edges.end(), row_edges[i].begin(), row_edges[i].end());
+				std::vector<weighted_edge<T> >().swap(row_edges[i]);
+			}
+
+			return edges;
+		}
+
+		/*
+		 * Fills the rows.size() x size() matrix result with the distances
+		 * distance(rows[r], j) from the given points to all points.
+		 */
+		template<class T>
+		static void distance_block(const finite_metric_space<T> & metric_space, const std::vector<std::size_t> & rows, basic_matrix<T> & result)
+		{
+			const std::size_t n = metric_space.size();
+			const std::size_t row_blocks = (rows.size() + ROW_BLOCK - 1) / ROW_BLOCK;
+			const std::size_t column_blocks = (n + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+
+			CPH_OMP(parallel)
+			{
+				std::vector<T> tile(ROW_BLOCK * COLUMN_BLOCK);
+
+				CPH_OMP(for schedule(static))
+				for (std::size_t tile_index = 0; tile_index < row_blocks * column_blocks; tile_index++)
+				{
+					const std::size_t row_begin = (tile_index / column_blocks) * ROW_BLOCK;
+					const std::size_t row_count = std::min(row_begin + ROW_BLOCK, rows.size()) - row_begin;
+					const std::size_t column_begin = (tile_index % column_blocks) * COLUMN_BLOCK;
+					const std::size_t column_end = std::min(column_begin + COLUMN_BLOCK, n);
+					const std::size_t column_count = column_end - column_begin;
+
+					metric_space.distances(&rows[row_begin], row_count, column_begin, column_end, &tile[0]);
+
+					for (std::size_t r = 0; r < row_count; r++)
+					{
+						for (std::size_t j = 0; j < column_count; j++)
+						{
+							result(row_begin + r, column_begin + j) = tile[r * column_count + j];
+						}
+					}
+				}
+			}
+		}
+
+		/*
+		 * The largest distance(i, j), i < j, over all pairs of points.
+		 */
+		template<class T>
+		static T diameter(const finite_metric_space<T> & metric_space)
+		{
+			const std::size_t n = metric_space.size();
+			const std::size_t row_blocks = (n + ROW_BLOCK - 1) / ROW_BLOCK;
+			T result(0);
+
+			CPH_OMP(parallel)
+			{
+				std::vector<T> tile(ROW_BLOCK * COLUMN_BLOCK);
+				std::vector<std::size_t> rows(ROW_BLOCK);
+				T thread_result(0);
+
+				CPH_OMP(for schedule(dynamic, 1) nowait)
+				for (std::size_t block = 0; block < row_blocks; block++)
+				{
+					const std::size_t row_begin = block * ROW_BLOCK;
+					const std::size_t row_count = std::min(row_begin + ROW_BLOCK, n) - row_begin;
+
+					for (std::size_t r = 0; r < row_count; r++)
+					{
+						rows[r] = row_begin + r;
+					}
+
+					for (std::size_t column_begin = row_begin + 1; column_begin < n; column_begin += COLUMN_BLOCK)
+					{
+						const std::size_t column_end = std::min(column_begin + COLUMN_BLOCK, n);
+						const std::size_t column_count = column_end - column_begin;
+
+						metric_space.distances(&rows[0], row_count, column_begin, column_end, &tile[0]);
+
+						for (std::size_t r = 0; r < row_count; r++)
+						{
+							for (std::size_t j = std::max(column_begin, rows[r] + 1); j < column_end; j++)
+							{
+								thread_result = std::max(thread_result, tile[r * column_count + j - column_begin]);
+							}
+						}
+					}
+				}
+
+				CPH_OMP(critical)
+				{
+					result = std::max(result, thread_result);
+				}
+			}
+
+			return result;
+		}
+
+		/*
+		 * The enclosing radius min_i max_j distance(i, j): past it, some point is
+		 * joined to all others and the Vietoris-Rips complex is a cone. Since
+		 * only radii below bound are of interest, the scan of a row is abandoned
+		 * as soon as its maximum reaches the smallest one found so far or the
+		 * bound, and bound is returned if no row stays below it. The rows are
+		 * scanned in chunks which grow up to COLUMN_BLOCK, so that far away points
+		 * cut most scans short after a few distances.
+		 *
+		 * The radius of the center found is recomputed with the distances
+		 * ordered as in the edges of the complex, distance(min(i, j), max(i, j)),
+		 * so that all its edges are present at the returned value even when the
+		 * distances are not exactly symmetric.
+		 */
+		template<class T>
+		static T enclosing_radius(const finite_metric_space<T> & metric_space, const T bound = std::numeric_limits<T>::max())
+		{
+			const std::size_t n = metric_space.size();
+			T best(bound);
+			std::size_t center(n);
+
+			CPH_OMP(parallel)
+			{
+				std::vector<T> chunk(COLUMN_BLOCK);
+				T thread_best(bound);
+				std::size_t thread_center(n);
+
+				CPH_OMP(for schedule(dynamic, 64) nowait)
+				for (std::size_t i = 0; i < n; i++)
+				{
+					T radius(0);
+					std::size_t chunk_size(64);
+
+					for (std::size_t column_begin = 0; column_begin < n && radius < thread_best; column_begin += chunk_size, chunk_size = (2 * chunk_size < COLUMN_BLOCK ? 2 * chunk_size : COLUMN_BLOCK))
+					{
+						const std::size_t column_end = std::min(column_begin + chunk_size, n);
+
+						metric_space.distances(&i, 1, column_begin, column_end, &chunk[0]);
+
+						for (std::size_t j = column_begin; j < column_end; j++)
+						{
+							radius = std::max(radius, chunk[j - column_begin]);
+						}
+					}
+
+					if (radius < thread_best)
+					{
+						thread_best = radius;
+						thread_center = i;
+					}
+				}
+
+				CPH_OMP(critical)
+				{
+					if (thread_best < best || (thread_best == best && thread_center < center))
+					{
+						best = thread_best;
+						center = thread_center;
+					}
+				}
+			}
+
+			if (center == n)
+			{
+				return bound;
+			}
+
+			T radius(0);
+			for (std::size_t j = 0; j < n; j++)
+			{
+				if (j != center)
+				{
+					radius = std::max(radius, j < center ? metric_space.distance(j, center) : metric_space.distance(center, j));
+				}
+			}
+
+			return std::min(radius, bound);
+		}
+
+		/*
+		 * The distances distance(row, j) from one point to all points, computed
+		 * in parallel over column blocks.
+		 */
+		template<class T>
+		static void distance_row(const finite_metric_space<T> & metric_space, const std::size_t row, std::vector<T> & result)
+		{
+			result.resize(metric_space.size());
+			if (!result.empty())
+			{
+				pairwise_distances::distance_row(metric_space, row, &result[0]);
+			}
+		}
+
+		/*
+		 * As above, written to the n entries starting at result.
+		 */
+		template<class T>
+		static void distance_row(const finite_metric_space<T> & metric_space, const std::size_t row, T * result)
+		{
+			const std::size_t n = metric_space.size();
+			const std::size_t column_blocks = (n + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+
+			CPH_OMP(parallel for schedule(static))
+			for (std::size_t block = 0; block < column_blocks; block++)
+			{
+				const std::size_t column_begin = block * COLUMN_BLOCK;
+				metric_space.distances(&row, 1, column_begin, std::min(column_begin + COLUMN_BLOCK, n), &result[column_begin]);
+			}
+		}
+	};
+
+}
+
+#endif /* PAIRWISE_DISTANCES_H_ */
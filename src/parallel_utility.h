@@ -0,0 +1,79 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef PARALLEL_UTILITY_H_
+#define PARALLEL_UTILITY_H_
+
+#include <cstddef>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// CPH_OMP(directive) stands for #pragma omp directive, and for nothing when
+// OpenMP is not available, so that serial builds do not warn about unknown
+// pragmas
+#define CPH_OMP_STRING(...) #__VA_ARGS__
+#ifdef _OPENMP
+#define CPH_OMP(...) _Pragma(CPH_OMP_STRING(omp __VA_ARGS__))
+#else
+#define CPH_OMP(...)
+#endif
+
+namespace cph
+{
+	/*
+	 * Thin wrappers around the OpenMP runtime so that the rest of the code
+	 * compiles unchanged (and runs serially) when OpenMP is not available.
+	 */
+	class parallel_utility
+	{
+	private:
+		parallel_utility()
+		{
+		}
+
+	public:
+		virtual ~parallel_utility()
+		{
+		}
+
+		static std::size_t max_threads()
+		{
+#ifdef _OPENMP
+			return (std::size_t) omp_get_max_threads();
+#else
+			return 1;
+#endif
+		}
+
+		/*
+		 * The number of threads of the current parallel region.
+		 */
+		static std::size_t thread_count()
+		{
+#ifdef _OPENMP
+			return (std::size_t) omp_get_num_threads();
+#else
+			return 1;
+#endif
+		}
+
+		static std::size_t thread_index()
+		{
+#ifdef _OPENMP
+			return (std::size_t) omp_get_thread_num();
+#else
+			return 0;
+#endif
+		}
+	};
+
+}
+
+#endif /* PARALLEL_UTILITY_H_ */
@@ -12,6 +12,7 @@
 #include "simplex.h"
 #include "simplex_stream.h"
 #include "barcode_collection.h"
+#include "complex_size_estimate.h"
 
 #include <vector>
 #include <set>
@@ -23,6 +24,61 @@
 namespace cph
 {
 
+	/*
+	 * The filtration order used by the reduction when the whole stream is
+	 * available: simplices are compared by filtration value, then by simplex.
+	 */
+	template<class B, class T>
+	class stream_filtration_order
+	{
+	private:
+		const simplex_stream<B, T> & _stream;
+		auxilary_comparison<B, T> _comparator;
+
+	public:
+		stream_filtration_order(const simplex_stream<B, T> & stream) :
+			_stream(stream), _comparator(stream.get_filtered_comparator())
+		{
+		}
+
+		inline T get_filtration_value(const B & simplex) const
+		{
+			return this->_stream.get_filtration_value(simplex);
+		}
+
+		inline bool operator()(const B & s1, const B & s2)
+		{
+			return this->_comparator(s1, s2);
+		}
+	};
+
+	/*
+	 * The filtration order used when simplices are fed to the reduction one at a
+	 * time: simplices are compared by the position at which they arrived.
+	 */
+	template<class B, class T>
+	class arrival_filtration_order
+	{
+	private:
+		const std::map<B, std::pair<T, std::size_t> > & _positions;
+
+	public:
+		arrival_filtration_order(const std::map<B, std::pair<T, std::size_t> > & positions) :
+			_positions(positions)
+		{
+		}
+
+		inline T get_filtration_value(const B & simplex) const
+		{
+			return this->_positions.find(simplex)->second.first;
+		}
+
+		inline bool operator()(const B & s1, const B & s2)
+		{
+			return (this->_positions.find(s1)->second.second < this->_positions.find(s2)->second.second);
+		}
+	};
+
 	template<class B, class T>
 	class persistence_algorithm
 	{
@@ -32,9 +88,13 @@ namespace cph
 		std::set<B> * _marked_simplices;
 		std::map<B, std::set<B> > * _T;
 
+		// state of the incremental interface
+		std::map<B, std::pair<T, std::size_t> > * _positions;
+		barcode_collection<T> * _intervals;
+
 	public:
 		persistence_algorithm(const typename std::size_t max_dimension = 2)
-			: _max_dimension(max_dimension)
+			: _max_dimension(max_dimension), _marked_simplices(0), _T(0), _positions(0), _intervals(0)
 		{
 		}
 		virtual ~persistence_algorithm()
@@ -50,39 +110,135 @@ namespace cph
 			this->_marked_simplices = new std::set<B>();
 
 			barcode_collection<T> intervals;
+			stream_filtration_order<B, T> order(stream);
 
 			for (typename std::vector<B>::const_iterator iter = begin; iter != end; iter++)
 			{
-   			    B simplex = (*iter);
+				this->reduce(*iter, order, intervals);
+			}
 
-				if (simplex.dimension() > this->_max_dimension + 1)
-				{
-					continue;
-				}
+			this->add_essential_intervals(order, intervals);
+
+			delete (this->_T);
+			delete (this->_marked_simplices);
+
+			return intervals;
+		}
+
+		/*
+		 * Incremental interface: after begin_stream, the simplices are passed to
+		 * add_simplex one at a time, in filtration order, and end_stream returns the
+		 * intervals. This allows the reduction to run while the filtration is still
+		 * being constructed.
+		 *
+		 * The simplices of dimension max_dimension + 1 are never the face of a
+		 * later simplex, so their position is dropped as soon as they are reduced
+		 * and they are never marked. The state kept is thus that of the simplices
+		 * of dimension at most max_dimension, which in a flag complex are far
+		 * fewer than those of the top dimension.
+		 */
+		void begin_stream()
+		{
+			this->_T = new std::map<B, std::set<B> >();
+			this->_marked_simplices = new std::set<B>();
+			this->_positions = new std::map<B, std::pair<T, std::size_t> >();
+			this->_intervals = new barcode_collection<T>();
+		}
 
-				std::set<B> d = this->remove_pivot_rows(simplex, stream);
+		void add_simplex(const B & simplex, const T & filtration_value)
+		{
+			if (simplex.dimension() > this->_max_dimension + 1)
+			{
+				return;
+			}
+
+			const std::size_t position = this->_positions->size();
+			this->_positions->operator[](simplex) = std::make_pair(filtration_value, position);
+
+			arrival_filtration_order<B, T> order(*this->_positions);
+			this->reduce(simplex, order, *this->_intervals);
+
+			if (simplex.dimension() > this->_max_dimension)
+			{
+				this->_positions->erase(simplex);
+			}
+		}
+
+		barcode_collection<T> end_stream()
+		{
+			arrival_filtration_order<B, T> order(*this->_positions);
+			this->add_essential_intervals(order, *this->_intervals);
+
+			barcode_collection<T> intervals(*this->_intervals);
+
+			delete (this->_T);
+			delete (this->_marked_simplices);
+			delete (this->_positions);
+			delete (this->_intervals);
+
+			return intervals;
+		}
+
+		/*
+		 * Rough number of bytes used by compute_intervals on a stream with the given
+		 * number of simplices per dimension: every simplex ends up either in the set
+		 * of marked simplices or as the key of a stored chain, and a stored chain is
+		 * assumed to be about as large as a boundary.
+		 */
+		static double projected_memory(const std::vector<double> & simplex_counts)
+		{
+			double bytes(0);
+			for (std::size_t d = 0; d < simplex_counts.size(); d++)
+			{
+				const double node_bytes = complex_size_estimate::TREE_NODE_OVERHEAD + sizeof(B) + complex_size_estimate::HEAP_OVERHEAD + (d + 1)
+						* sizeof(std::size_t);
+				const double face_node_bytes = complex_size_estimate::TREE_NODE_OVERHEAD + sizeof(B) + complex_size_estimate::HEAP_OVERHEAD + d
+						* sizeof(std::size_t);
+				bytes += simplex_counts[d] * (node_bytes + (d + 1) * face_node_bytes);
+			}
+			return bytes;
+		}
 
-				if (d.empty())
+	private:
+		template<class O>
+		void reduce(const B & simplex, O & order, barcode_collection<T> & intervals)
+		{
+			if (simplex.dimension() > this->_max_dimension + 1)
+			{
+				return;
+			}
+
+			std::set<B> d = this->remove_pivot_rows(simplex, order);
+
+			if (d.empty())
+			{
+				// a simplex of the top dimension is not a face of any other, and
+				// gives no interval of its own
+				if (simplex.dimension() <= this->_max_dimension)
 				{
 					this->_marked_simplices->insert(simplex);
 				}
-				else
-				{
-					B & sigma_j = simplex;
-					const B sigma_i = this->get_maximum_object(d, stream);
-					typename std::size_t k = sigma_i.dimension();
-					this->_T->operator[](sigma_i) = d;
+			}
+			else
+			{
+				const B & sigma_j = simplex;
+				const B sigma_i = this->get_maximum_object(d, order);
+				typename std::size_t k = sigma_i.dimension();
+				this->_T->operator[](sigma_i) = d;
 
-					T t_i = stream.get_filtration_value(sigma_i);
-					T t_j = stream.get_filtration_value(sigma_j);
+				T t_i = order.get_filtration_value(sigma_i);
+				T t_j = order.get_filtration_value(sigma_j);
 
-					if ((t_j - t_i > 0) && (k <= this->_max_dimension))
-					{
-						intervals.add_interval(k, t_i, t_j);
-					}
+				if ((t_j - t_i > 0) && (k <= this->_max_dimension))
+				{
+					intervals.add_interval(k, t_i, t_j);
 				}
 			}
+		}
 
+		template<class O>
+		void add_essential_intervals(const O & order, barcode_collection<T> & intervals) const
+		{
 			for (typename std::set<B>::const_iterator iter = this->_marked_simplices->begin(); iter != this->_marked_simplices->end(); iter++)
 			{
 				if (this->_T->find(*iter) == this->_T->end() || this->_T->find(*iter)->second.empty())
@@ -90,22 +246,16 @@ namespace cph
 					typename std::size_t k = (*iter).dimension();
 					if (k <= this->_max_dimension)
 					{
-						T t = stream.get_filtration_value(*iter);
+						T t = order.get_filtration_value(*iter);
 						intervals.add_interval(k, t);
 					}
 				}
 			}
-
-			delete (this->_T);
-			delete (this->_marked_simplices);
-
-			return intervals;
 		}
 
-	private:
-		std::set<B> remove_pivot_rows(const B & simplex, const simplex_stream<B, T> & stream)
+		template<class O>
+		std::set<B> remove_pivot_rows(const B & simplex, O & order)
 		{
-			typedef std::set<B> type;
 			std::set<B> d = simplex.boundary_set();
 
 			// removed non-marked simplices from d
@@ -125,7 +275,7 @@ namespace cph
 
 			while (!d.empty())
 			{
-				const B & sigma_i = this->get_maximum_object(d, stream);
+				const B & sigma_i = this->get_maximum_object(d, order);
 
 				if (this->_T->find(sigma_i) == this->_T->end())
 				{
@@ -148,9 +298,10 @@ namespace cph
 			return d;
 		}
 
-		inline const B & get_maximum_object(const std::set<B> & chain, const simplex_stream<B, T> & stream) const
+		template<class O>
+		inline const B & get_maximum_object(const std::set<B> & chain, O & order) const
 		{
-			return *std::max_element(chain.begin(), chain.end(), stream.get_filtered_comparator());
+			return *std::max_element(chain.begin(), chain.end(), order);
 		}
 
 		inline bool get_coefficient(const std::set<B> & chain, const B & object) const
@@ -26,6 +26,15 @@ namespace cph
 		{
 		}
 
+		/*
+		 * Seeds the generator, so that the random choices which follow can be
+		 * repeated.
+		 */
+		static void seed(const unsigned int value)
+		{
+			srand(value);
+		}
+
 		static std::size_t random_integer(const std::size_t lowest, const std::size_t highest)
 		{
 			return (rand() % (highest - lowest + 1)) + lowest;
@@ -134,6 +134,18 @@ namespace cph
 			std::sort(this->_simplices.begin(), this->_simplices.end(), this->get_filtered_comparator());
 		}
 
+		// merges [begin, begin + prefix_size) and [begin + prefix_size, end), which must both be sorted
+		void merge_sorted_suffix(const std::size_t prefix_size)
+		{
+			std::inplace_merge(this->_simplices.begin(), this->_simplices.begin() + prefix_size, this->_simplices.end(), this->get_filtered_comparator());
+		}
+
+		void clear()
+		{
+			this->_filtration_values.clear();
+			this->_simplices.clear();
+		}
+
 		auxilary_comparison<B, T> get_filtered_comparator() const
 		{
 			return auxilary_comparison<B, T> (this->_filtration_values);
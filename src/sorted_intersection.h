@@ -0,0 +1,133 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef SORTED_INTERSECTION_H_
+#define SORTED_INTERSECTION_H_
+
+#include <cstddef>
+
+namespace cph
+{
+
+	/*
+	 * Intersection of strictly increasing arrays. The result is written into a
+	 * caller supplied buffer which must be able to hold min(a_size, b_size)
+	 * elements, and the number of elements written is returned.
+	 */
+	class sorted_intersection
+	{
+	private:
+		// when one array is this many times longer than the other, galloping wins over merging
+		static const std::size_t GALLOP_RATIO = 32;
+
+		sorted_intersection()
+		{
+		}
+
+	public:
+		virtual ~sorted_intersection()
+		{
+		}
+
+		template<class V>
+		static std::size_t intersect(const V * a, const std::size_t a_size, const V * b, const std::size_t b_size, V * result)
+		{
+			if (a_size == 0 || b_size == 0)
+			{
+				return 0;
+			}
+
+			if (a_size * GALLOP_RATIO < b_size)
+			{
+				return sorted_intersection::gallop(a, a_size, b, b_size, result);
+			}
+
+			if (b_size * GALLOP_RATIO < a_size)
+			{
+				return sorted_intersection::gallop(b, b_size, a, a_size, result);
+			}
+
+			return sorted_intersection::merge(a, a_size, b, b_size, result);
+		}
+
+		/*
+		 * Branch-free merge: the comparison results are turned into increments,
+		 * so the loop does not suffer from unpredictable branches.
+		 */
+		template<class V>
+		static std::size_t merge(const V * a, const std::size_t a_size, const V * b, const std::size_t b_size, V * result)
+		{
+			std::size_t i(0), j(0), k(0);
+
+			while (i < a_size && j < b_size)
+			{
+				const V x = a[i];
+				const V y = b[j];
+				result[k] = x;
+				k += (x == y);
+				i += (x <= y);
+				j += (y <= x);
+			}
+
+			return k;
+		}
+
+		/*
+		 * For each element of the short array, do an exponential search followed
+		 * by a binary search in the remaining part of the long array.
+		 */
+		template<class V>
+		static std::size_t gallop(const V * small, const std::size_t small_size, const V * large, const std::size_t large_size, V * result)
+		{
+			std::size_t k(0), low(0);
+
+			for (std::size_t i = 0; i < small_size && low < large_size; i++)
+			{
+				const V x = small[i];
+
+				std::size_t step(1), high(low);
+				while (high < large_size && large[high] < x)
+				{
+					low = high + 1;
+					high += step;
+					step *= 2;
+				}
+
+				if (high > large_size)
+				{
+					high = large_size;
+				}
+
+				// the first element >= x lies in [low, high]
+				while (low < high)
+				{
+					std::size_t middle = low + (high - low) / 2;
+					if (large[middle] < x)
+					{
+						low = middle + 1;
+					}
+					else
+					{
+						high = middle;
+					}
+				}
+
+				if (low < large_size && large[low] == x)
+				{
+					result[k++] = x;
+					low++;
+				}
+			}
+
+			return k;
+		}
+	};
+
+}
+
+#endif /* SORTED_INTERSECTION_H_ */
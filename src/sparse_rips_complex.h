@@ -0,0 +1,222 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef SPARSE_RIPS_COMPLEX_H_
+#define SPARSE_RIPS_COMPLEX_H_
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "flag_complex.h"
+#include "weighted_edge.h"
+#include "landmark_selector.h"
+#include "spatial_index_factory.h"
+#include "parallel_utility.h"
+
+namespace cph
+{
+
+	/*
+	 * The sparse Vietoris-Rips filtration of Sheehy, "Linear-size approximations
+	 * to the Vietoris-Rips filtration", in the scale of vietoris_rips_complex (an
+	 * edge of length d enters at d rather than d / 2).
+	 *
+	 * The points are put in a greedy permutation, and each point p gets the
+	 * distance lambda_p to the points before it. For 0 < epsilon < 1, point p is
+	 * perturbed by the weight
+	 *
+	 * W_p(s) = 0                      for s <= 2 lambda_p / epsilon
+	 *        = s - 2 lambda_p / epsilon for s <= 2 lambda_p / (epsilon (1 - epsilon))
+	 *        = epsilon s              otherwise,
+	 *
+	 * the edge [pq] enters at the first s with d(p, q) + (W_p(s) + W_q(s)) / 2 <= s,
+	 * and no simplex containing p enters after the deletion time
+	 * 2 lambda_p / (epsilon (1 - epsilon)). The resulting filtration has O(n)
+	 * simplices in doubling metrics, and its persistence diagram approximates that
+	 * of the Rips filtration within a factor of 1 + O(epsilon).
+	 *
+	 * Since an edge [pq], with q after p in the permutation, must enter before the
+	 * deletion time of q, it suffices to look for the neighbors of q within that
+	 * radius; a spatial index is used for this when one is available.
+	 */
+	template<class T>
+	class sparse_rips_complex: public flag_complex<T>
+	{
+	private:
+		const T _epsilon;
+
+	public:
+		sparse_rips_complex(const finite_metric_space<T> & metric_space, const T & max_filtration_value, const int max_dimension, const T epsilon) :
+			flag_complex<T> (metric_space, max_filtration_value, max_dimension, metric_space.size(), false), _epsilon(epsilon)
+		{
+		}
+
+		virtual ~sparse_rips_complex()
+		{
+		}
+
+		virtual std::vector<weighted_edge<T> > create_1_skeleton()
+		{
+			const std::size_t n = this->_metric_space->size();
+
+			std::vector<T> insertion_radii;
+			const std::vector<std::size_t> order = landmark_selector::greedy_permutation(*this->_metric_space, insertion_radii);
+
+			std::vector<std::size_t> rank(n);
+			std::vector<T> lambda(n);
+			this->_vertex_deletion_times.assign(n, T(0));
+			for (std::size_t r = 0; r < n; r++)
+			{
+				rank[order[r]] = r;
+				lambda[order[r]] = insertion_radii[r];
+				this->_vertex_deletion_times[order[r]] = 2 * insertion_radii[r] / (this->_epsilon * (1 - this->_epsilon));
+			}
+
+			spatial_index<T> * index = spatial_index_factory::create(*this->_metric_space);
+			std::vector<std::vector<std::pair<std::size_t, T> > > neighbors(n);
+
+			CPH_OMP(parallel)
+			{
+				std::vector<std::pair<std::size_t, T> > candidates;
+
+				CPH_OMP(for schedule(dynamic, 64))
+				for (std::size_t q = 0; q < n; q++)
+				{
+					if (rank[q] == 0)
+					{
+						continue;
+					}
+
+					const T radius = std::min(this->_vertex_deletion_times[q], this->_max_filtration_value);
+
+					candidates.clear();
+					if (index != 0)
+					{
+						index->radius_query(q, radius, candidates);
+					}
+					else
+					{
+						for (std::size_t p = 0; p < n; p++)
+						{
+							if (p != q)
+							{
+								candidates.push_back(std::make_pair(p, p < q ? this->_metric_space->distance(p, q) : this->_metric_space->distance(q, p)));
+							}
+						}
+					}
+
+					for (typename std::vector<std::pair<std::size_t, T> >::const_iterator iter = candidates.begin(); iter != candidates.end(); iter++)
+					{
+						const std::size_t p = iter->first;
+						if (rank[p] > rank[q] || iter->second > radius)
+						{
+							continue;
+						}
+
+						const T time = this->edge_time(iter->second, lambda[p], lambda[q]);
+						if (time <= this->_vertex_deletion_times[q] && time <= this->_vertex_deletion_times[p] && time <= this->_max_filtration_value)
+						{
+							neighbors[q].push_back(std::make_pair(p, time));
+						}
+					}
+
+					std::sort(neighbors[q].begin(), neighbors[q].end());
+				}
+			}
+
+			delete (index);
+
+			std::vector<weighted_edge<T> > edges;
+			for (std::size_t q = 0; q < n; q++)
+			{
+				for (typename std::vector<std::pair<std::size_t, T> >::const_iterator iter = neighbors[q].begin(); iter != neighbors[q].end(); iter++)
+				{
+					edges.push_back(weighted_edge<T> (iter->first, q, iter->second));
+				}
+			}
+
+			return edges;
+		}
+
+	private:
+		T weight(const T s, const T lambda) const
+		{
+			if (lambda == std::numeric_limits<T>::infinity() || s <= 2 * lambda / this->_epsilon)
+			{
+				return T(0);
+			}
+
+			if (s <= 2 * lambda / (this->_epsilon * (1 - this->_epsilon)))
+			{
+				return s - 2 * lambda / this->_epsilon;
+			}
+
+			return this->_epsilon * s;
+		}
+
+		/*
+		 * The smallest root of g(s) = d + (W_p(s) + W_q(s)) / 2 - s. The function g
+		 * is non-increasing and piecewise linear, with breakpoints where one of the
+		 * weights changes regime, so the root is found by evaluating g at the
+		 * breakpoints and interpolating.
+		 */
+		T edge_time(const T d, const T lambda_p, const T lambda_q) const
+		{
+			if (d <= 0)
+			{
+				return T(0);
+			}
+
+			// at most two breakpoints for each weight, inserted in sorted order
+			T breakpoints[4];
+			std::size_t breakpoint_count(0);
+			const T lambdas[2] = { lambda_p, lambda_q };
+			for (std::size_t k = 0; k < 2; k++)
+			{
+				if (lambdas[k] == std::numeric_limits<T>::infinity())
+				{
+					continue;
+				}
+
+				const T values[2] = { 2 * lambdas[k] / this->_epsilon, 2 * lambdas[k] / (this->_epsilon * (1 - this->_epsilon)) };
+				for (std::size_t v = 0; v < 2; v++)
+				{
+					std::size_t position = breakpoint_count++;
+					for (; position > 0 && breakpoints[position - 1] > values[v]; position--)
+					{
+						breakpoints[position] = breakpoints[position - 1];
+					}
+					breakpoints[position] = values[v];
+				}
+			}
+
+			T previous(0), g_previous(d);
+			for (std::size_t k = 0; k < breakpoint_count; k++)
+			{
+				const T s = breakpoints[k];
+				const T g = d + (this->weight(s, lambda_p) + this->weight(s, lambda_q)) / 2 - s;
+
+				if (g <= 0)
+				{
+					return previous + (s - previous) * g_previous / (g_previous - g);
+				}
+
+				previous = s;
+				g_previous = g;
+			}
+
+			// past the last breakpoint, every finite weight is epsilon s
+			const T slope = 1 - this->_epsilon * T(breakpoint_count / 2) / 2;
+			return previous + g_previous / slope;
+		}
+	};
+
+}
+
+#endif /* SPARSE_RIPS_COMPLEX_H_ */
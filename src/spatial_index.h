@@ -0,0 +1,161 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef SPATIAL_INDEX_H_
+#define SPATIAL_INDEX_H_
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <queue>
+#include <limits>
+
+#include "finite_metric_space.h"
+#include "weighted_edge.h"
+#include "parallel_utility.h"
+
+namespace cph
+{
+
+	/*
+	 * Base class of the indices over the points of a finite metric space which
+	 * answer radius queries without computing all the distances.
+	 *
+	 * The pruning of the indices relies on the triangle inequality, with a small
+	 * relative tolerance for rounding, so they must only be used for true metrics.
+	 * The distances reported are always computed by the metric space itself, as
+	 * distance(i, j) with i < j, so that they are bit for bit those of a brute
+	 * force computation.
+	 */
+	template<class T>
+	class spatial_index
+	{
+	protected:
+		typedef std::vector<std::pair<std::size_t, T> > neighbor_list;
+
+		// relative slack added to the pruning bounds
+		static const double TOLERANCE;
+
+		const finite_metric_space<T> & _metric_space;
+
+	public:
+		spatial_index(const finite_metric_space<T> & metric_space) :
+			_metric_space(metric_space)
+		{
+		}
+
+		virtual ~spatial_index()
+		{
+		}
+
+		/*
+		 * Appends to result the points j >= first_point, j != i, with
+		 * distance(i, j) <= radius, together with their distances, in no particular
+		 * order.
+		 */
+		virtual void radius_query(const std::size_t i, const T radius, neighbor_list & result, const std::size_t first_point = 0) const = 0;
+
+		/*
+		 * Replaces the contents of result by the k points j != i which come first
+		 * in the order of (distance(i, j), j), together with their distances,
+		 * sorted in that order. Fewer points are returned if there are not enough.
+		 */
+		virtual void nearest_neighbors(const std::size_t i, const std::size_t k, neighbor_list & result) const = 0;
+
+		/*
+		 * The edges of length at most radius, in the same order as a loop over all
+		 * pairs i < j would produce them. The queries are run in parallel. With a
+		 * positive first_point, only the edges with j >= first_point are returned.
+		 */
+		std::vector<weighted_edge<T> > radius_edges(const T radius, const std::size_t first_point = 0) const
+		{
+			const std::size_t n = this->_metric_space.size();
+			std::vector<neighbor_list> neighbors(n);
+
+			CPH_OMP(parallel for schedule(dynamic, 64))
+			for (std::size_t i = 0; i < n; i++)
+			{
+				this->radius_query(i, radius, neighbors[i], std::max(i + 1, first_point));
+				std::sort(neighbors[i].begin(), neighbors[i].end());
+			}
+
+			std::vector<weighted_edge<T> > edges;
+			for (std::size_t i = 0; i < n; i++)
+			{
+				for (typename neighbor_list::const_iterator iter = neighbors[i].begin(); iter != neighbors[i].end(); iter++)
+				{
+					edges.push_back(weighted_edge<T> (i, iter->first, iter->second));
+				}
+				neighbor_list().swap(neighbors[i]);
+			}
+
+			return edges;
+		}
+
+	protected:
+		/*
+		 * The candidates of a nearest neighbor query, as a max-heap of
+		 * (distance, point) pairs holding the best k seen so far.
+		 */
+		typedef std::priority_queue<std::pair<T, std::size_t> > candidate_heap;
+
+		/*
+		 * Offers point j to the heap of the k best candidates.
+		 */
+		static inline void offer(candidate_heap & candidates, const std::size_t k, const T distance, const std::size_t j)
+		{
+			const std::pair<T, std::size_t> candidate(distance, j);
+			if (candidates.size() < k)
+			{
+				candidates.push(candidate);
+			}
+			else if (candidate < candidates.top())
+			{
+				candidates.pop();
+				candidates.push(candidate);
+			}
+		}
+
+		/*
+		 * The distance beyond which no point can improve the heap.
+		 */
+		static inline T candidate_bound(const candidate_heap & candidates, const std::size_t k)
+		{
+			return (candidates.size() < k ? std::numeric_limits<T>::max() : candidates.top().first);
+		}
+
+		/*
+		 * Empties the heap into result, in increasing order.
+		 */
+		static void drain(candidate_heap & candidates, neighbor_list & result)
+		{
+			result.resize(candidates.size());
+			for (std::size_t r = candidates.size(); r > 0; r--)
+			{
+				result[r - 1] = std::make_pair(candidates.top().second, candidates.top().first);
+				candidates.pop();
+			}
+		}
+
+		inline T ordered_distance(const std::size_t i, const std::size_t j) const
+		{
+			return (i < j ? this->_metric_space.distance(i, j) : this->_metric_space.distance(j, i));
+		}
+
+		static inline T slack(const T value)
+		{
+			return T(TOLERANCE * (value < 0 ? -value : value));
+		}
+	};
+
+	template<class T>
+	const double spatial_index<T>::TOLERANCE = 1e-10;
+
+}
+
+#endif /* SPATIAL_INDEX_H_ */
@@ -0,0 +1,63 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef SPATIAL_INDEX_FACTORY_H_
+#define SPATIAL_INDEX_FACTORY_H_
+
+#include "spatial_index.h"
+#include "kd_tree.h"
+#include "vp_tree.h"
+#include "euclidean_metric_space.h"
+
+namespace cph
+{
+
+	class spatial_index_factory
+	{
+	private:
+		spatial_index_factory()
+		{
+		}
+
+	public:
+		virtual ~spatial_index_factory()
+		{
+		}
+
+		/*
+		 * Returns a k-d tree for point clouds under a metric it supports, and a
+		 * vantage point tree otherwise. Returns 0 when no index can be used, in
+		 * which case the caller falls back to computing all the distances. The
+		 * caller owns the index.
+		 */
+		template<class T>
+		static spatial_index<T> * create(const finite_metric_space<T> & metric_space)
+		{
+			const euclidean_metric_space<T> * point_cloud = dynamic_cast<const euclidean_metric_space<T> *> (&metric_space);
+
+			if (point_cloud != 0)
+			{
+				if (kd_tree<T>::supports(point_cloud->metric_type()))
+				{
+					return new kd_tree<T> (metric_space, point_cloud->points(), point_cloud->metric_type());
+				}
+
+				// the minkowski distance is only a metric for p >= 1
+				if (point_cloud->metric_type() == minkowski && point_cloud->p() < 1)
+				{
+					return 0;
+				}
+			}
+
+			return new vp_tree<T> (metric_space);
+		}
+	};
+
+}
+
+#endif /* SPATIAL_INDEX_FACTORY_H_ */
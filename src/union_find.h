@@ -0,0 +1,97 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef UNION_FIND_H_
+#define UNION_FIND_H_
+
+#include <vector>
+#include <algorithm>
+
+namespace cph
+{
+
+	/*
+	 * Disjoint sets over {0, ..., n - 1} with path compression and union by rank.
+	 */
+	class union_find
+	{
+	private:
+		std::vector<std::size_t> _parents;
+		std::vector<std::size_t> _ranks;
+		std::size_t _set_count;
+
+	public:
+		union_find(const std::size_t size) :
+			_parents(size), _ranks(size, 0), _set_count(size)
+		{
+			for (std::size_t x = 0; x < size; x++)
+			{
+				this->_parents[x] = x;
+			}
+		}
+
+		virtual ~union_find()
+		{
+		}
+
+		std::size_t find(std::size_t x)
+		{
+			std::size_t root = x;
+			while (this->_parents[root] != root)
+			{
+				root = this->_parents[root];
+			}
+
+			while (this->_parents[x] != root)
+			{
+				std::size_t next = this->_parents[x];
+				this->_parents[x] = root;
+				x = next;
+			}
+
+			return root;
+		}
+
+		/*
+		 * Merges the sets containing x and y, and returns false if they were
+		 * already the same set.
+		 */
+		bool join(const std::size_t x, const std::size_t y)
+		{
+			std::size_t a = this->find(x);
+			std::size_t b = this->find(y);
+
+			if (a == b)
+			{
+				return false;
+			}
+
+			if (this->_ranks[a] < this->_ranks[b])
+			{
+				std::swap(a, b);
+			}
+
+			this->_parents[b] = a;
+			if (this->_ranks[a] == this->_ranks[b])
+			{
+				this->_ranks[a]++;
+			}
+			this->_set_count--;
+
+			return true;
+		}
+
+		std::size_t set_count() const
+		{
+			return this->_set_count;
+		}
+	};
+
+}
+
+#endif /* UNION_FIND_H_ */
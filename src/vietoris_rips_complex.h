@@ -10,7 +10,9 @@
 #define VIETORIS_RIPS_COMPLEX_H_
 
 #include "flag_complex.h"
-#include "basic_graph.h"
+#include "weighted_edge.h"
+#include "spatial_index_factory.h"
+#include "pairwise_distances.h"
 
 namespace cph
 {
@@ -20,10 +22,13 @@ namespace cph
 	{
 
 	private:
+		const bool _use_spatial_index;
 
 	public:
-		vietoris_rips_complex(const finite_metric_space<T> & metric_space, const T & max_filtration_value, const int max_dimension) :
-			flag_complex<T> (metric_space, max_filtration_value, max_dimension, metric_space.size())
+		vietoris_rips_complex(const finite_metric_space<T> & metric_space, const T & max_filtration_value, const int max_dimension,
+				const bool collapse_edges = false, const bool use_spatial_index = false) :
+			flag_complex<T> (metric_space, max_filtration_value, max_dimension, metric_space.size(), collapse_edges),
+					_use_spatial_index(use_spatial_index)
 		{
 		}
 
@@ -31,27 +36,77 @@ namespace cph
 		{
 		}
 
-		virtual basic_graph<T> * create_1_skeleton()
+		/*
+		 * All the edges up to the maximum filtration value, found by
+		 * threshold_edges.
+		 */
+		virtual std::vector<weighted_edge<T> > create_1_skeleton()
 		{
-			std::size_t n = this->_metric_space.size();
+			return this->threshold_edges(0);
+		}
+
+		/*
+		 * Extends the filtration to a larger metric space, whose leading points must
+		 * be the points of the current one. Only the distances from the new
+		 * points are computed, the existing edges are read back from the stream, and
+		 * only the cofaces containing a new vertex are generated and merged into the
+		 * stream. The new edges are found as in create_1_skeleton. Since collapses of
+		 * the old 1-skeleton need not remain valid once new points are added, a
+		 * complex with edge collapses is rebuilt from scratch.
+		 */
+		void add_points(const finite_metric_space<T> & metric_space)
+		{
+			const std::size_t n = metric_space.size();
+			const std::size_t first_new_vertex = this->_vertex_set_size;
+			const bool constructed = (this->size() > 0);
+
+			this->_metric_space = &metric_space;
+			this->_vertex_set_size = n;
+
+			if (this->_collapse_edges || !constructed)
+			{
+				this->clear();
+				this->construct();
+				return;
+			}
+
+			std::vector<weighted_edge<T> > edges;
 
-			basic_graph<T> * graph(new basic_graph<T> ());
+			for (typename std::vector<simplex<std::size_t> >::const_iterator iter = this->begin(); iter != this->end(); iter++)
+			{
+				if (iter->dimension() == 1)
+				{
+					edges.push_back(weighted_edge<T> ((*iter)[0], (*iter)[1], this->get_filtration_value(*iter)));
+				}
+			}
 
-			T distance;
+			const std::vector<weighted_edge<T> > new_edges = this->threshold_edges(first_new_vertex);
+			edges.insert(edges.end(), new_edges.begin(), new_edges.end());
 
-			for (std::size_t i = 0; i < n; i++)
+			this->expand(edges, first_new_vertex);
+		}
+
+	private:
+		/*
+		 * The edges [ij], i < j, j >= first_point, up to the maximum filtration
+		 * value. With a spatial index, only the pairs the index cannot rule out
+		 * are measured, which is close to O(n log n + E) when the threshold is
+		 * small. Otherwise the pairs are measured with the tiled kernel.
+		 */
+		std::vector<weighted_edge<T> > threshold_edges(const std::size_t first_point) const
+		{
+			if (this->_use_spatial_index)
 			{
-				for (std::size_t j = i + 1; j < n; j++)
+				spatial_index<T> * index = spatial_index_factory::create(*this->_metric_space);
+				if (index != 0)
 				{
-					distance = this->_metric_space.distance(i, j);
-					if (distance <= this->_max_filtration_value)
-					{
-						graph->add_edge(i, j, distance);
-					}
+					std::vector<weighted_edge<T> > edges = index->radius_edges(this->_max_filtration_value, first_point);
+					delete (index);
+					return edges;
 				}
 			}
 
-			return graph;
+			return pairwise_distances::threshold_edges(*this->_metric_space, this->_max_filtration_value, first_point);
 		}
 
 	};
@@ -0,0 +1,229 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef VP_TREE_H_
+#define VP_TREE_H_
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "spatial_index.h"
+#include "parallel_utility.h"
+
+namespace cph
+{
+
+	/*
+	 * Vantage point tree, which only needs the distance function and therefore
+	 * works for any metric. Each node picks a vantage point v and splits the
+	 * remaining points at the median mu of their distances to v; by the triangle
+	 * inequality, a query ball of radius r around q only meets the inner half if
+	 * d(q, v) <= mu + r, and the outer half if d(q, v) >= mu - r.
+	 *
+	 * The subtrees of large nodes are built in parallel as OpenMP tasks.
+	 */
+	template<class T>
+	class vp_tree: public spatial_index<T>
+	{
+	private:
+		static const std::size_t LEAF_SIZE = 16;
+		static const std::size_t PARALLEL_CUTOFF = 4096;
+
+		struct node
+		{
+			// leaves hold the points _permutation[begin, end), inner nodes the vantage point
+			std::size_t begin, end;
+			std::size_t vantage_point;
+			T mu;
+			node * inside;
+			node * outside;
+
+			node(const std::size_t b, const std::size_t e) :
+				begin(b), end(e), vantage_point(0), mu(0), inside(0), outside(0)
+			{
+			}
+
+			~node()
+			{
+				delete (inside);
+				delete (outside);
+			}
+		};
+
+		std::vector<std::size_t> _permutation;
+		node * _root;
+
+	public:
+		vp_tree(const finite_metric_space<T> & metric_space) :
+			spatial_index<T> (metric_space), _permutation(metric_space.size()), _root(0)
+		{
+			for (std::size_t i = 0; i < this->_permutation.size(); i++)
+			{
+				this->_permutation[i] = i;
+			}
+
+			CPH_OMP(parallel)
+			{
+				CPH_OMP(single)
+				this->_root = this->build(0, this->_permutation.size());
+			}
+		}
+
+		virtual ~vp_tree()
+		{
+			delete (this->_root);
+		}
+
+		void radius_query(const std::size_t i, const T radius, typename spatial_index<T>::neighbor_list & result, const std::size_t first_point = 0) const
+		{
+			this->radius_query(this->_root, i, radius, result, first_point);
+		}
+
+		void nearest_neighbors(const std::size_t i, const std::size_t k, typename spatial_index<T>::neighbor_list & result) const
+		{
+			typename spatial_index<T>::candidate_heap candidates;
+			if (k > 0)
+			{
+				this->nearest_neighbors(this->_root, i, k, candidates);
+			}
+			spatial_index<T>::drain(candidates, result);
+		}
+
+	private:
+		node * build(const std::size_t begin, const std::size_t end)
+		{
+			node * result = new node(begin, end);
+
+			if (end - begin <= LEAF_SIZE)
+			{
+				return result;
+			}
+
+			const std::size_t v = this->_permutation[begin];
+			std::vector<std::pair<T, std::size_t> > distances;
+			distances.reserve(end - begin - 1);
+			for (std::size_t k = begin + 1; k < end; k++)
+			{
+				distances.push_back(std::make_pair(this->ordered_distance(v, this->_permutation[k]), this->_permutation[k]));
+			}
+
+			const std::size_t median = distances.size() / 2;
+			std::nth_element(distances.begin(), distances.begin() + median, distances.end());
+
+			for (std::size_t k = 0; k < distances.size(); k++)
+			{
+				this->_permutation[begin + 1 + k] = distances[k].second;
+			}
+
+			result->vantage_point = v;
+			result->mu = distances[median].first;
+
+			const std::size_t middle = begin + 1 + median + 1;
+
+			CPH_OMP(task if (end - begin > PARALLEL_CUTOFF))
+			result->inside = this->build(begin + 1, middle);
+
+			result->outside = this->build(middle, end);
+
+			CPH_OMP(taskwait)
+
+			return result;
+		}
+
+		void radius_query(const node * current, const std::size_t i, const T radius, typename spatial_index<T>::neighbor_list & result,
+				const std::size_t first_point) const
+		{
+			if (current->inside == 0)
+			{
+				for (std::size_t k = current->begin; k < current->end; k++)
+				{
+					const std::size_t j = this->_permutation[k];
+					if (j >= first_point && j != i)
+					{
+						const T distance = this->ordered_distance(i, j);
+						if (distance <= radius)
+						{
+							result.push_back(std::make_pair(j, distance));
+						}
+					}
+				}
+				return;
+			}
+
+			const std::size_t v = current->vantage_point;
+			const T distance = (v == i ? T(0) : this->ordered_distance(i, v));
+
+			if (v >= first_point && v != i && distance <= radius)
+			{
+				result.push_back(std::make_pair(v, distance));
+			}
+
+			const T slack = spatial_index<T>::slack(distance + current->mu + radius);
+
+			if (distance <= current->mu + radius + slack)
+			{
+				this->radius_query(current->inside, i, radius, result, first_point);
+			}
+
+			if (distance + radius + slack >= current->mu)
+			{
+				this->radius_query(current->outside, i, radius, result, first_point);
+			}
+		}
+
+		/*
+		 * Descends first into the side of the vantage point the query lies on; the
+		 * other side is only visited if the ball of the current k-th distance
+		 * crosses the sphere of radius mu.
+		 */
+		void nearest_neighbors(const node * current, const std::size_t i, const std::size_t k, typename spatial_index<T>::candidate_heap & candidates) const
+		{
+			if (current->inside == 0)
+			{
+				for (std::size_t r = current->begin; r < current->end; r++)
+				{
+					const std::size_t j = this->_permutation[r];
+					if (j != i)
+					{
+						spatial_index<T>::offer(candidates, k, this->ordered_distance(i, j), j);
+					}
+				}
+				return;
+			}
+
+			const std::size_t v = current->vantage_point;
+			const T distance = (v == i ? T(0) : this->ordered_distance(i, v));
+
+			if (v != i)
+			{
+				spatial_index<T>::offer(candidates, k, distance, v);
+			}
+
+			const bool inside_first = (distance <= current->mu);
+			for (std::size_t side = 0; side < 2; side++)
+			{
+				const bool inside = (inside_first == (side == 0));
+				const T bound = spatial_index<T>::candidate_bound(candidates, k);
+				const T slack = spatial_index<T>::slack(distance + current->mu + bound);
+
+				if (inside && distance <= current->mu + bound + slack)
+				{
+					this->nearest_neighbors(current->inside, i, k, candidates);
+				}
+				else if (!inside && distance + bound + slack >= current->mu)
+				{
+					this->nearest_neighbors(current->outside, i, k, candidates);
+				}
+			}
+		}
+	};
+
+}
+
+#endif /* VP_TREE_H_ */
@@ -0,0 +1,55 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef WEIGHTED_EDGE_H_
+#define WEIGHTED_EDGE_H_
+
+#include <cstddef>
+
+namespace cph
+{
+
+	/*
+	 * An edge of a weighted graph, stored with i < j.
+	 */
+	template<class W, class V = std::size_t>
+	struct weighted_edge
+	{
+		V i, j;
+		W weight;
+
+		weighted_edge() :
+			i(0), j(0), weight(0)
+		{
+		}
+
+		weighted_edge(const V & u, const V & v, const W w) :
+			i(u < v ? u : v), j(u < v ? v : u), weight(w)
+		{
+		}
+
+		// orders edges by weight, breaking ties by the vertices
+		bool operator <(const weighted_edge<W, V> & other) const
+		{
+			if (this->weight != other.weight)
+			{
+				return (this->weight < other.weight);
+			}
+
+			if (this->j != other.j)
+			{
+				return (this->j < other.j);
+			}
+
+			return (this->i < other.i);
+		}
+	};
+
+}
+
+#endif /* WEIGHTED_EDGE_H_ */
@@ -0,0 +1,144 @@
+//============================================================================
+// Name        : cph
+// Author      : Andrew Tausz <atausz@stanford.edu>
+// Version     : 1.0
+// Copyright   : Copyright © 2011 Andrew Tausz
+// Description : A basic package for persistent homology in C++
+//============================================================================
+
+#ifndef ZERO_DIMENSIONAL_PERSISTENCE_H_
+#define ZERO_DIMENSIONAL_PERSISTENCE_H_
+
+#include <vector>
+#include <algorithm>
+
+#include "weighted_edge.h"
+#include "union_find.h"
+#include "barcode_collection.h"
+
+namespace cph
+{
+
+	/*
+	 * The 0-dimensional persistence of a flag filtration only depends on its
+	 * 1-skeleton: in filtration order, every edge joining two components kills
+	 * one of them. This is computed with a union-find pass over the sorted edges,
+	 * without creating any simplices.
+	 *
+	 * The edges are taken in the order of the simplex stream, i.e. by weight and
+	 * then lexicographically, so that the intervals are the same, and listed in
+	 * the same order, as those computed by persistence_algorithm.
+	 */
+	class zero_dimensional_persistence
+	{
+	private:
+		zero_dimensional_persistence()
+		{
+		}
+
+		template<class T>
+		struct stream_edge_order
+		{
+			bool operator()(const weighted_edge<T> & a, const weighted_edge<T> & b) const
+			{
+				if (a.weight != b.weight)
+				{
+					return (a.weight < b.weight);
+				}
+				if (a.i != b.i)
+				{
+					return (a.i < b.i);
+				}
+				return (a.j < b.j);
+			}
+		};
+
+	public:
+		virtual ~zero_dimensional_persistence()
+		{
+		}
+
+		template<class T>
+		static barcode_collection<T> compute_intervals(std::vector<weighted_edge<T> > edges, const std::size_t vertex_count)
+		{
+			std::sort(edges.begin(), edges.end(), stream_edge_order<T> ());
+
+			barcode_collection<T> intervals;
+			union_find components(vertex_count);
+
+			for (typename std::vector<weighted_edge<T> >::const_iterator iter = edges.begin(); iter != edges.end(); iter++)
+			{
+				if (components.join(iter->i, iter->j) && iter->weight > 0)
+				{
+					intervals.add_interval(0, T(0), iter->weight);
+				}
+			}
+
+			for (std::size_t c = 0; c < components.set_count(); c++)
+			{
+				intervals.add_interval(0, T(0));
+			}
+
+			return intervals;
+		}
+
+		/*
+		 * The same for a filtration in which vertex v enters at vertex_values[v],
+		 * no later than its edges, and vertices entering after
+		 * max_filtration_value are left out. When an edge joins two components,
+		 * the one whose oldest vertex entered last dies.
+		 */
+		template<class T>
+		static barcode_collection<T> compute_intervals(std::vector<weighted_edge<T> > edges, const std::vector<T> & vertex_values,
+				const T max_filtration_value)
+		{
+			std::sort(edges.begin(), edges.end(), stream_edge_order<T> ());
+
+			const std::size_t vertex_count = vertex_values.size();
+			barcode_collection<T> intervals;
+			union_find components(vertex_count);
+
+			// the oldest vertex of the component of each root
+			std::vector<std::size_t> oldest(vertex_count);
+			for (std::size_t v = 0; v < vertex_count; v++)
+			{
+				oldest[v] = v;
+			}
+
+			for (typename std::vector<weighted_edge<T> >::const_iterator iter = edges.begin(); iter != edges.end(); iter++)
+			{
+				std::size_t a = oldest[components.find(iter->i)];
+				std::size_t b = oldest[components.find(iter->j)];
+
+				if (!components.join(iter->i, iter->j))
+				{
+					continue;
+				}
+
+				if (vertex_values[b] < vertex_values[a] || (vertex_values[b] == vertex_values[a] && b < a))
+				{
+					std::swap(a, b);
+				}
+
+				oldest[components.find(a)] = a;
+				if (vertex_values[b] < iter->weight)
+				{
+					intervals.add_interval(0, vertex_values[b], iter->weight);
+				}
+			}
+
+			for (std::size_t v = 0; v < vertex_count; v++)
+			{
+				if (components.find(v) == v && vertex_values[oldest[v]] <= max_filtration_value)
+				{
+					intervals.add_interval(0, vertex_values[oldest[v]]);
+				}
+			}
+
+			return intervals;
+		}
+	};
+
+}
+
+#endif /* ZERO_DIMENSIONAL_PERSISTENCE_H_ */